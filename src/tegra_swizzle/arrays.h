@@ -4,7 +4,7 @@
 // The code can be found here: https://github.com/KillzXGaming/Switch-Toolbox/pull/419#issuecomment-959980096
 // This comes from the Ryujinx emulator: https://github.com/Ryujinx/Ryujinx/blob/master/LICENSE.txt.
 
-size_t align_layer_size(
+inline size_t align_layer_size(
     size_t layer_size,
     size_t height,
     size_t depth,
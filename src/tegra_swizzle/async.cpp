@@ -0,0 +1,222 @@
+#include <tegra_swizzle/lib.h>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+// Shared state between a job and the thread running its mipmaps.
+struct SurfaceJob::State {
+    std::mutex mutex;
+    std::condition_variable mip_ready;
+    std::vector<CompletedMip> completed;
+    size_t returned_count = 0;
+    // Lowered to the completed count if the job is cancelled or fails.
+    size_t mip_count = 0;
+    bool cancelled = false;
+    std::exception_ptr error;
+    bool finished = false;
+
+    // Processes every mipmap on the thread, executor, or context running the job.
+    std::function<void()> run;
+    // The thread running the job if neither the executor nor the context can run background work.
+    std::thread thread;
+};
+
+SurfaceJob::SurfaceJob() = default;
+
+SurfaceJob::SurfaceJob(std::unique_ptr<State> state)
+    : _state(std::move(state)) {
+}
+
+SurfaceJob::SurfaceJob(SurfaceJob&& other) noexcept = default;
+
+SurfaceJob& SurfaceJob::operator=(SurfaceJob&& other) noexcept {
+    if (this != &other) {
+        wait();
+        _state = std::move(other._state);
+    }
+    return *this;
+}
+
+SurfaceJob::~SurfaceJob() {
+    wait();
+}
+
+std::optional<CompletedMip> SurfaceJob::next() {
+    if (!_state) {
+        return std::nullopt;
+    }
+
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    if (_state->returned_count == _state->mip_count) {
+        return std::nullopt;
+    }
+
+    _state->mip_ready.wait(lock, [&]() {
+        return _state->completed.size() > _state->returned_count || _state->returned_count == _state->mip_count;
+    });
+    if (_state->returned_count == _state->completed.size()) {
+        return std::nullopt;
+    }
+    return _state->completed[_state->returned_count++];
+}
+
+bool SurfaceJob::cancelled() {
+    if (!_state) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->cancelled;
+}
+
+std::exception_ptr SurfaceJob::error() {
+    if (!_state) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_state->mutex);
+    return _state->error;
+}
+
+void SurfaceJob::wait() {
+    if (!_state) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_state->mutex);
+        _state->mip_ready.wait(lock, [&]() { return _state->finished; });
+    }
+    if (_state->thread.joinable()) {
+        _state->thread.join();
+    }
+}
+
+template <bool DESWIZZLE>
+SurfaceJob start_surface_job(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    MipOrder order,
+    const SwizzleOptions& options
+) {
+    const size_t surface_size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+    const size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+
+    const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, expected_size, source.size());
+    if (source_error) {
+        throw_runtime_error(swizzle_error_message(source_error->error));
+    }
+
+    const std::optional<SwizzleErrorInfo> result_error = check_size(SwizzleError::DestinationTooSmall, surface_size, result.size());
+    if (result_error) {
+        throw_runtime_error(swizzle_error_message(result_error->error));
+    }
+
+    std::unique_ptr<SurfaceJob::State> state = std::make_unique<SurfaceJob::State>();
+    state->mip_count = layout.mips.size();
+    state->completed.reserve(layout.mips.size());
+
+    // The order only changes when each mipmap is written, so the result is the same for every order.
+    std::vector<size_t> mip_order(layout.mips.size());
+    for (size_t i = 0; i < mip_order.size(); ++i) {
+        mip_order[i] = i;
+    }
+    if (order == MipOrder::SmallestFirst) {
+        std::stable_sort(mip_order.begin(), mip_order.end(), [&](size_t a, size_t b) {
+            return layout.mips[a].deswizzled_size < layout.mips[b].deswizzled_size;
+        });
+    }
+
+    // Copy the layout and options, since the caller's values may not outlive the job.
+    state->run = [
+        state = state.get(),
+        layout,
+        mip_order = std::move(mip_order),
+        source = reinterpret_cast<const unsigned char*>(source.data()),
+        source_size = source.size(),
+        result = reinterpret_cast<unsigned char*>(result.data()),
+        options
+    ]() {
+        // Returns `false` if the stop token or deadline stopped the job.
+        auto run_mips = [&]() {
+            if (!DESWIZZLE) {
+                zero_layer_padding(layout, result);
+            }
+
+            for (size_t i : mip_order) {
+                const MipLayout& mip = layout.mips[i];
+                const MipWork work = surface_mip_work<DESWIZZLE>(mip, layout.bytes_per_pixel, source, source_size, result, 0, options);
+                if (!run_mip_work(std::span<const MipWork>(&work, 1), options)) {
+                    return false;
+                }
+
+                CompletedMip completed;
+                completed.layer = mip.layer;
+                completed.mip = mip.mip;
+                completed.offset = DESWIZZLE ? mip.deswizzled_offset : mip.swizzled_offset;
+                completed.size = DESWIZZLE ? mip.deswizzled_size : mip.swizzled_size;
+                {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->completed.push_back(completed);
+                }
+                state->mip_ready.notify_all();
+            }
+            return true;
+        };
+
+        // Stop at the first failure like for a stop, since the job has no caller to throw to.
+        bool stopped = false;
+        std::exception_ptr error;
+#if defined(TEGRA_SWIZZLE_EXCEPTIONS)
+        try {
+            stopped = !run_mips();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+#else
+        stopped = !run_mips();
+#endif
+
+        // Partially written mipmaps are never returned.
+        // Notify while holding the lock, since the job may be destroyed as soon as the lock is released.
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->cancelled = stopped;
+        state->error = error;
+        state->mip_count = state->completed.size();
+        state->finished = true;
+        state->mip_ready.notify_all();
+    };
+
+    // Run the mipmaps on the executor or context if they can run background work.
+    // Otherwise start a thread for the job that waits while the mipmaps are split across the threads from `options`.
+    auto run_state = [](void* data) { static_cast<SurfaceJob::State*>(data)->run(); };
+    const bool posted = (options.executor != nullptr && options.executor->post(run_state, state.get()))
+        || (options.context != nullptr && options.context->post(run_state, state.get()));
+    if (!posted) {
+        state->thread = std::thread([state = state.get()]() { state->run(); });
+    }
+    return SurfaceJob(std::move(state));
+}
+
+SurfaceJob swizzle_surface_async(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    MipOrder order,
+    const SwizzleOptions& options
+) {
+    return start_surface_job<false>(layout, source, result, order, options);
+}
+
+SurfaceJob deswizzle_surface_async(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    MipOrder order,
+    const SwizzleOptions& options
+) {
+    return start_surface_job<true>(layout, source, result, order, options);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/surface.h>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+//! Functions for swizzling or deswizzling a surface in the background
+//! while handing out each mipmap as soon as it is finished.
+//!
+//! Upload paths can copy each finished mipmap to a staging buffer while the remaining mipmaps are still being processed.
+//! Use [MipOrder::SmallestFirst] to finish the low resolution mipmaps first,
+//! so a blurry version of a large texture can be shown right away.
+
+/// The order for processing the mipmaps of a surface in the background.
+enum class MipOrder {
+    /// Process mipmaps in memory order by array layer and then mipmap.
+    Surface,
+    /// Process the smallest mipmaps of every array layer first.
+    SmallestFirst
+};
+
+/// A mipmap that has been completely written to the result of a [SurfaceJob].
+struct CompletedMip {
+    size_t layer;
+    size_t mip;
+    /// The offset in bytes of the mipmap in the result.
+    size_t offset;
+    /// The size in bytes of the mipmap in the result.
+    size_t size;
+};
+
+/// A surface being swizzled or deswizzled in the background.
+/// Create a job with [swizzle_surface_async] or [deswizzle_surface_async].
+///
+/// The job runs on [SwizzleOptions::executor] if [SwizzleExecutor::post] accepts it,
+/// then on a worker of [SwizzleOptions::context] if the context has any workers,
+/// and otherwise on a thread started for the job.
+/// Jobs that share a context run one after another, and each job splits its mipmaps across the other workers.
+///
+/// Call [next] or iterate over the job to receive each mipmap as it finishes.
+/// The bytes of a [CompletedMip] in the result can be read as soon as it is returned.
+/// The destructor waits for the remaining mipmaps, so the source, result, and context must outlive the job.
+///
+/// A job stopped by [SwizzleOptions::stop_token] or [SwizzleOptions::deadline]
+/// or by an exception like a failure to start threads
+/// returns only the mipmaps that finished before the stop.
+class SurfaceJob {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = CompletedMip;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const CompletedMip*;
+        using reference = const CompletedMip&;
+
+        Iterator() = default;
+        explicit Iterator(SurfaceJob* job) : _job(job), _mip(job->next()) {}
+
+        const CompletedMip& operator*() const { return *_mip; }
+        const CompletedMip* operator->() const { return &*_mip; }
+
+        Iterator& operator++() {
+            _mip = _job->next();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        bool operator==(const Iterator& other) const { return !_mip.has_value() && !other._mip.has_value(); }
+
+    private:
+        SurfaceJob* _job = nullptr;
+        std::optional<CompletedMip> _mip;
+    };
+
+    SurfaceJob();
+    SurfaceJob(SurfaceJob&& other) noexcept;
+    SurfaceJob& operator=(SurfaceJob&& other) noexcept;
+    ~SurfaceJob();
+
+    /// Waits for the next mipmap to finish.
+    /// Returns [None] after every mipmap has been returned.
+    std::optional<CompletedMip> next();
+
+    /// Waits for every mipmap to finish.
+    /// Mipmaps that have not been returned by [next] yet are still returned by later calls.
+    void wait();
+
+    /// Returns `true` if the stop token or deadline stopped the job before every mipmap finished.
+    /// Call after [wait] or after [next] returns [None] to get the final result.
+    bool cancelled();
+
+    /// The exception that stopped the job before every mipmap finished or null if there was no exception.
+    /// Call after [wait] or after [next] returns [None] to get the final result.
+    std::exception_ptr error();
+
+    Iterator begin() { return Iterator(this); }
+    Iterator end() { return Iterator(); }
+
+private:
+    struct State;
+
+    explicit SurfaceJob(std::unique_ptr<State> state);
+
+    template <bool DESWIZZLE>
+    friend SurfaceJob start_surface_job(
+        const SurfaceLayout& layout,
+        std::span<const std::byte> source,
+        std::span<std::byte> result,
+        MipOrder order,
+        const SwizzleOptions& options
+    );
+
+    std::unique_ptr<State> _state;
+};
+
+/// Starts swizzling all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` in the background.
+/// The mipmaps are split across the threads from `options` like [swizzle_surface].
+///
+/// `source` and `result` must outlive the returned job.
+/// Throws if `source` has fewer bytes than `layout.deswizzled_size`
+/// or `result` has fewer bytes than `layout.swizzled_size`.
+/// The sizes are checked before starting the job.
+SurfaceJob swizzle_surface_async(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    MipOrder order = MipOrder::Surface,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Starts deswizzling all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` in the background.
+/// The mipmaps are split across the threads from `options` like [deswizzle_surface].
+///
+/// `source` and `result` must outlive the returned job.
+/// Throws if `source` has fewer bytes than `layout.swizzled_size`
+/// or `result` has fewer bytes than `layout.deswizzled_size`.
+/// The sizes are checked before starting the job.
+SurfaceJob deswizzle_surface_async(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    MipOrder order = MipOrder::Surface,
+    const SwizzleOptions& options = SwizzleOptions()
+);
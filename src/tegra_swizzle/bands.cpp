@@ -0,0 +1,181 @@
+#include <tegra_swizzle/lib.h>
+
+// The number of rows in each band of a mipmap.
+static size_t band_height(BandSize band_size, size_t height, BlockHeight block_height) {
+    if (band_size == BandSize::DepthSlice) {
+        return height;
+    }
+    return std::min(GOB_HEIGHT_IN_BYTES * static_cast<size_t>(block_height), height);
+}
+
+// Deswizzles every band of a single mipmap into `buffer` and passes it to `sink`.
+static void deswizzle_mip_bands(
+    size_t layer,
+    size_t mip,
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    BandSize band_size,
+    unsigned char* buffer,
+    size_t buffer_size,
+    const DeswizzledBandSink& sink,
+    StopCheck& stop,
+    const SwizzleOptions& options
+) {
+    // Each band covers a single depth slice, so avoid orders that visit several depth slices in a task.
+    SwizzleOptions band_options = options;
+    if (band_options.traversal_order == TraversalOrder::Swizzled) {
+        band_options.traversal_order = TraversalOrder::BlockColumns;
+    }
+
+    // Use the same kernels and source prefetching as the other deswizzle functions.
+    // The sink reads each band right away, so keep the band in the cache instead of using non-temporal stores.
+    MipWork work = mip_work<true>(
+        width,
+        height,
+        depth,
+        source,
+        source_size,
+        buffer,
+        buffer_size,
+        block_height,
+        block_depth,
+        bytes_per_pixel,
+        band_options
+    );
+    work.streaming = false;
+    work.complete_gob = gob_kernels(options).deswizzle;
+
+    // Split each row of blocks into rows of GOBs, so a single band can be split across threads.
+    split_tasks_into_gob_rows(work);
+
+    const size_t row_size_in_bytes = width * bytes_per_pixel;
+    const size_t rows_per_band = band_height(band_size, height, block_height);
+    const size_t tasks_per_slice = height_in_blocks(height, static_cast<size_t>(block_height)) * work.row_bands;
+    const size_t tasks_per_band = band_size == BandSize::DepthSlice
+        ? tasks_per_slice
+        : work.row_bands;
+
+    const bool parallel = row_size_in_bytes * rows_per_band >= options.parallel_threshold_in_bytes;
+    const size_t thread_count = parallel ? std::min(resolved_thread_count(options), tasks_per_band) : 1;
+
+    for (size_t z = 0; z < depth; ++z) {
+        for (size_t y = 0; y < height; y += rows_per_band) {
+            if (stop.stopped()) {
+                throw_runtime_error(swizzle_error_message(SwizzleError::Cancelled));
+            }
+
+            const size_t rows = std::min(rows_per_band, height - y);
+            work.linear_origin = (z * height + y) * row_size_in_bytes;
+
+            const size_t task_start = z * tasks_per_slice + (y / rows_per_band) * tasks_per_band;
+            if (thread_count > 1) {
+                parallel_for(thread_count, thread_count, options, [&](size_t i) {
+                    work.run(work, task_start + i * tasks_per_band / thread_count, task_start + (i + 1) * tasks_per_band / thread_count);
+                });
+            }
+            else {
+                work.run(work, task_start, task_start + tasks_per_band);
+            }
+
+            DeswizzledBand band;
+            band.layer = layer;
+            band.mip = mip;
+            band.z = z;
+            band.y = y;
+            band.width = width;
+            band.height = rows;
+            band.data = std::span<const std::byte>(reinterpret_cast<const std::byte*>(buffer), row_size_in_bytes * rows);
+            sink(band);
+        }
+    }
+}
+
+void deswizzle_block_linear_bands(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    BandSize band_size,
+    const DeswizzledBandSink& sink,
+    const SwizzleOptions& options
+) {
+    if (source.size() < swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel)) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    SwizzleBuffer buffer = output_buffer(
+        width * bytes_per_pixel * band_height(band_size, height, block_height),
+        scratch_resource(options),
+        options
+    );
+
+    StopCheck stop(options);
+    deswizzle_mip_bands(
+        0,
+        0,
+        width,
+        height,
+        depth,
+        reinterpret_cast<const unsigned char*>(source.data()),
+        source.size(),
+        block_height,
+        block_depth(depth),
+        bytes_per_pixel,
+        band_size,
+        reinterpret_cast<unsigned char*>(buffer.data()),
+        buffer.size(),
+        sink,
+        stop,
+        options
+    );
+}
+
+void deswizzle_surface_bands(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    BandSize band_size,
+    const DeswizzledBandSink& sink,
+    const SwizzleOptions& options
+) {
+    if (source.size() < layout.swizzled_size) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    // Reuse a single buffer large enough for the bands of every mipmap.
+    size_t buffer_size = 0;
+    for (const MipLayout& mip : layout.mips) {
+        const size_t size = mip.width * layout.bytes_per_pixel * band_height(band_size, mip.height, mip.block_height);
+        buffer_size = std::max(buffer_size, size);
+    }
+    SwizzleBuffer buffer = output_buffer(buffer_size, scratch_resource(options), options);
+
+    StopCheck stop(options);
+    for (const MipLayout& mip : layout.mips) {
+        deswizzle_mip_bands(
+            mip.layer,
+            mip.mip,
+            mip.width,
+            mip.height,
+            mip.depth,
+            reinterpret_cast<const unsigned char*>(source.data()) + mip.swizzled_offset,
+            mip.swizzled_size,
+            mip.block_height,
+            mip.block_depth,
+            layout.bytes_per_pixel,
+            band_size,
+            reinterpret_cast<unsigned char*>(buffer.data()),
+            buffer.size(),
+            sink,
+            stop,
+            options
+        );
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/surface.h>
+#include <functional>
+#include <span>
+#include <cstddef>
+
+//! Functions for deswizzling a mipmap or surface one band of rows at a time.
+//!
+//! The deswizzled data for a huge texture or 3D volume may not fit in memory at once.
+//! The band functions deswizzle into a small buffer that is reused for every band
+//! and pass each finished band to a callback like a file writer or image encoder.
+//! Peak memory for the output is a single band instead of the entire deswizzled surface.
+
+/// The rows in each band passed to a [DeswizzledBandSink].
+enum class BandSize {
+    /// A single row of blocks in a single depth slice with `block_height * 8` rows.
+    /// This is the smallest band that covers whole GOBs.
+    BlockRow,
+    /// All the rows in a single depth slice.
+    DepthSlice
+};
+
+/// A band of deswizzled rows from a single depth slice of a mipmap.
+/// Dimensions and coordinates are in blocks like for [MipLayout].
+struct DeswizzledBand {
+    size_t layer;
+    size_t mip;
+    /// The depth slice of the band.
+    size_t z;
+    /// The first row of the band.
+    size_t y;
+    /// The width of the mipmap.
+    size_t width;
+    /// The number of rows in the band.
+    size_t height;
+    /// The tightly packed rows of the band with `width * height * bytes_per_pixel` bytes.
+    /// The data is only valid until the callback returns.
+    std::span<const std::byte> data;
+};
+
+/// A callback for each finished band.
+/// Bands are passed in order by layer, mipmap, depth slice, and row on the calling thread.
+using DeswizzledBandSink = std::function<void(const DeswizzledBand& band)>;
+
+/// Deswizzles the bytes from `source` like [deswizzle_block_linear] one band at a time
+/// and passes each finished band to `sink`.
+/// Only a single band of deswizzled data is allocated from the scratch memory of `options`.
+/// Bands at least [SwizzleOptions::parallel_threshold_in_bytes] in size are split across the threads from `options`.
+///
+/// The layer and mipmap of each band are always 0.
+/// Throws if `source` does not have at least as many bytes as the result of [swizzled_mip_size]
+/// or if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work between bands.
+/// Exceptions thrown by `sink` stop the work and are passed to the caller.
+void deswizzle_block_linear_bands(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    BandSize band_size,
+    const DeswizzledBandSink& sink,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// like [deswizzle_surface] one band at a time and passes each finished band to `sink`.
+/// Only the largest band of any mipmap is allocated from the scratch memory of `options`.
+///
+/// Throws if `source` has fewer bytes than `layout.swizzled_size`
+/// or if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work between bands.
+/// Exceptions thrown by `sink` stop the work and are passed to the caller.
+void deswizzle_surface_bands(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    BandSize band_size,
+    const DeswizzledBandSink& sink,
+    const SwizzleOptions& options = SwizzleOptions()
+);
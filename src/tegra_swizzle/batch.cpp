@@ -0,0 +1,122 @@
+#include <tegra_swizzle/lib.h>
+
+// Shared implementation for the batch functions.
+template <bool DESWIZZLE>
+SwizzleExpected<SurfaceBatch> try_swizzle_surfaces_inner(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<SurfaceBatch> {
+        SurfaceBatch batch;
+        batch.layouts.reserve(surfaces.size());
+        batch.offsets.reserve(surfaces.size());
+        batch.sizes.reserve(surfaces.size());
+
+        // Compute every layout and validate every source before allocating.
+        size_t total_size = 0;
+        for (const SurfaceDescriptor& surface : surfaces) {
+            SurfaceLayout layout = surface_layout(
+                surface.width,
+                surface.height,
+                surface.depth,
+                surface.block_dim,
+                surface.block_height_mip0,
+                surface.bytes_per_pixel,
+                surface.mipmap_count,
+                surface.layer_count
+            );
+
+            const size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+            const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, expected_size, surface.source.size());
+            if (source_error) {
+                return SwizzleUnexpected(*source_error);
+            }
+
+            const size_t offset = round_up(total_size, options.output_alignment);
+            const size_t size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+            batch.offsets.push_back(offset);
+            batch.sizes.push_back(size);
+            batch.layouts.push_back(std::move(layout));
+            total_size = offset + size;
+        }
+
+        batch.buffer = output_buffer(total_size, resource, options);
+        unsigned char* result = reinterpret_cast<unsigned char*>(batch.buffer.data());
+
+        // The swizzle functions only write the bytes of each surface.
+        size_t previous_end = 0;
+        for (size_t i = 0; i < surfaces.size(); ++i) {
+            std::fill(result + previous_end, result + batch.offsets[i], (unsigned char)0);
+            previous_end = batch.offsets[i] + batch.sizes[i];
+
+            if (!DESWIZZLE) {
+                zero_layer_padding(batch.layouts[i], result + batch.offsets[i]);
+            }
+        }
+
+        // Schedule the mipmaps of every surface together.
+        // The scheduler merges small mipmaps into larger tasks and splits large mipmaps across threads.
+        std::pmr::vector<MipWork> work(scratch_resource(options));
+        for (size_t i = 0; i < surfaces.size(); ++i) {
+            const SurfaceLayout& layout = batch.layouts[i];
+            const unsigned char* source = reinterpret_cast<const unsigned char*>(surfaces[i].source.data());
+            unsigned char* destination = result + batch.offsets[i];
+
+            for (const MipLayout& mip : layout.mips) {
+                work.push_back(surface_mip_work<DESWIZZLE>(mip, layout.bytes_per_pixel, source, surfaces[i].source.size(), destination, 0, options));
+            }
+        }
+
+        if (!run_mip_work(work, options)) {
+            return SwizzleUnexpected(SwizzleErrorInfo{ SwizzleError::Cancelled, 0, 0 });
+        }
+
+        return batch;
+    });
+}
+
+template <bool DESWIZZLE>
+SurfaceBatch swizzle_surfaces_inner(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    SwizzleExpected<SurfaceBatch> result = try_swizzle_surfaces_inner<DESWIZZLE>(surfaces, resource, options);
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+    return std::move(*result);
+}
+
+SurfaceBatch swizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    return swizzle_surfaces_inner<false>(surfaces, resource, options);
+}
+
+SurfaceBatch deswizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    return swizzle_surfaces_inner<true>(surfaces, resource, options);
+}
+
+SwizzleExpected<SurfaceBatch> try_swizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return try_swizzle_surfaces_inner<false>(surfaces, resource, options);
+}
+
+SwizzleExpected<SurfaceBatch> try_deswizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return try_swizzle_surfaces_inner<true>(surfaces, resource, options);
+}
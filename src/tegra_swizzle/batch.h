@@ -0,0 +1,105 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/surface.h>
+#include <tegra_swizzle/buffer.h>
+#include <tegra_swizzle/expected.h>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <vector>
+#include <cstddef>
+
+//! Functions for swizzling or deswizzling many independent surfaces in a single call.
+//!
+//! Archives often contain thousands of small textures like icons or font pages.
+//! Converting each texture with [swizzle_surface] allocates and runs every surface separately,
+//! so the fixed cost of each call dominates for tiny mipmaps.
+//! The batch functions compute every layout up front, allocate a single output buffer for all surfaces,
+//! and merge the small mipmaps of all surfaces into larger tasks that are split across threads.
+//!
+//! Large batches allocate a large output buffer that is usually faulted in from the operating system on every call.
+//! Set [SwizzleOptions::huge_pages] or pass a memory resource that reuses its memory between batches to avoid this cost.
+
+/// The parameters and data for a single surface in a batch.
+/// Dimensions are in pixels like for [surface_layout].
+struct SurfaceDescriptor {
+    size_t width;
+    size_t height;
+    size_t depth;
+    BlockDim block_dim;
+    /// Use [None] to infer the block height from the specified dimensions.
+    std::optional<BlockHeight> block_height_mip0;
+    size_t bytes_per_pixel;
+    size_t mipmap_count;
+    size_t layer_count;
+    /// The swizzled or deswizzled data for all array layers and mipmaps of the surface.
+    std::span<const std::byte> source;
+};
+
+/// The output of [swizzle_surfaces] or [deswizzle_surfaces].
+/// Every surface is stored in a single [SwizzleBuffer] in the same order as the descriptors.
+struct SurfaceBatch {
+    /// The layout of each surface.
+    std::vector<SurfaceLayout> layouts;
+    /// The offset in bytes of each surface in [buffer].
+    /// Each offset is aligned to [SwizzleOptions::output_alignment].
+    std::vector<size_t> offsets;
+    /// The size in bytes of each output surface.
+    std::vector<size_t> sizes;
+    /// The output for all surfaces.
+    /// Bytes between surfaces are zero.
+    SwizzleBuffer buffer;
+
+    /// The number of surfaces in the batch.
+    size_t size() const { return layouts.size(); }
+
+    /// The output data for the surface at `index`.
+    std::span<const std::byte> surface(size_t index) const {
+        return buffer.span().subspan(offsets[index], sizes[index]);
+    }
+};
+
+/// Swizzles all the array layers and mipmaps of every surface in `surfaces`
+/// into a single new [SwizzleBuffer] allocated from `resource`.
+/// The output for each surface is identical to [swizzle_surface].
+///
+/// Throws if any `source` has fewer bytes than [deswizzled_surface_size] for its surface.
+/// All sources are checked before allocating.
+SurfaceBatch swizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps of every surface in `surfaces`
+/// into a single new [SwizzleBuffer] allocated from `resource`.
+/// The output for each surface is identical to [deswizzle_surface].
+///
+/// Throws if any `source` has fewer bytes than [swizzled_surface_size] for its surface.
+/// All sources are checked before allocating.
+SurfaceBatch deswizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Swizzles every surface in `surfaces` like [swizzle_surfaces] without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if any `source` has fewer bytes than [deswizzled_surface_size] for its surface.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SurfaceBatch> try_swizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Deswizzles every surface in `surfaces` like [deswizzle_surfaces] without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if any `source` has fewer bytes than [swizzled_surface_size] for its surface.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SurfaceBatch> try_deswizzle_surfaces(
+    std::span<const SurfaceDescriptor> surfaces,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
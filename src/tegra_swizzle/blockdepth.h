@@ -21,7 +21,7 @@ constexpr size_t block_depth(size_t depth) {
     }
 }
 
-size_t mip_block_depth(size_t mip_depth, size_t gob_depth) {
+inline size_t mip_block_depth(size_t mip_depth, size_t gob_depth) {
     while (mip_depth <= gob_depth / 2 && gob_depth > 1) {
         gob_depth /= 2;
     }
@@ -27,7 +27,7 @@ let block_height_mip0 = block_height_mip0(height);
  let block_height_mip0 = block_height_mip0(div_round_up(height, 4));
  ```
   */
-BlockHeight block_height_mip0(size_t height) {
+inline BlockHeight block_height_mip0(size_t height) {
     const size_t height_and_half = height + (height / 2);
 
     if (height_and_half >= 128) {
@@ -73,7 +73,7 @@ for mip in 0..mipmap_count {
 }
 ```
  */
-BlockHeight mip_block_height(size_t mip_height, BlockHeight block_height_mip0) {
+inline BlockHeight mip_block_height(size_t mip_height, BlockHeight block_height_mip0) {
     size_t block_height = static_cast<size_t>(block_height_mip0);
     while (mip_height <= (block_height / 2) * 8 && block_height > 1) {
         block_height /= 2;
@@ -0,0 +1,32 @@
+#include <tegra_swizzle/lib.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+void advise_huge_pages(std::span<std::byte> buffer) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = round_up(reinterpret_cast<uintptr_t>(buffer.data()), page_size);
+    const uintptr_t end = (reinterpret_cast<uintptr_t>(buffer.data()) + buffer.size()) / page_size * page_size;
+    if (start < end) {
+        madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+    }
+#else
+    (void)buffer;
+#endif
+}
+
+SwizzleBuffer output_buffer(size_t size, std::pmr::memory_resource* resource, const SwizzleOptions& options) {
+    // Huge pages only help if the allocation starts on a huge page boundary.
+    const size_t alignment = options.huge_pages && size >= HUGE_PAGE_SIZE
+        ? std::max(options.output_alignment, HUGE_PAGE_SIZE)
+        : options.output_alignment;
+
+    SwizzleBuffer buffer(size, resource, alignment);
+    if (options.huge_pages) {
+        advise_huge_pages(buffer.span());
+    }
+    return buffer;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <tegra_swizzle/options.h>
+#include <memory_resource>
+#include <span>
+#include <cstddef>
+#include <utility>
+
+/// An owning buffer for the output of the allocating swizzle functions.
+///
+/// The memory comes from a [std::pmr::memory_resource], so results can be placed in arenas, pools,
+/// or any other caller provided allocator. The memory is returned to the same resource when the buffer is destroyed.
+/// The resource must outlive the buffer.
+class SwizzleBuffer {
+public:
+    /// Creates an empty buffer that owns no memory.
+    SwizzleBuffer() = default;
+
+    /// Allocates `size` uninitialized bytes from `resource` aligned to `alignment` bytes.
+    SwizzleBuffer(
+        size_t size,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        size_t alignment = alignof(std::max_align_t)
+    )
+        : _resource(resource), _size(size), _alignment(alignment) {
+        if (_size > 0) {
+            _data = static_cast<std::byte*>(_resource->allocate(_size, _alignment));
+        }
+    }
+
+    SwizzleBuffer(const SwizzleBuffer&) = delete;
+    SwizzleBuffer& operator=(const SwizzleBuffer&) = delete;
+
+    SwizzleBuffer(SwizzleBuffer&& other) noexcept
+        : _resource(other._resource),
+        _data(std::exchange(other._data, nullptr)),
+        _size(std::exchange(other._size, 0)),
+        _alignment(other._alignment) {
+    }
+
+    SwizzleBuffer& operator=(SwizzleBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            _resource = other._resource;
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _alignment = other._alignment;
+        }
+        return *this;
+    }
+
+    ~SwizzleBuffer() {
+        release();
+    }
+
+    std::byte* data() { return _data; }
+    const std::byte* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    /// The memory resource that owns the allocation.
+    std::pmr::memory_resource* resource() const { return _resource; }
+
+    std::span<std::byte> span() { return std::span<std::byte>(_data, _size); }
+    std::span<const std::byte> span() const { return std::span<const std::byte>(_data, _size); }
+
+private:
+    void release() {
+        if (_data != nullptr) {
+            _resource->deallocate(_data, _size, _alignment);
+            _data = nullptr;
+            _size = 0;
+        }
+    }
+
+    std::pmr::memory_resource* _resource = std::pmr::get_default_resource();
+    std::byte* _data = nullptr;
+    size_t _size = 0;
+    size_t _alignment = alignof(std::max_align_t);
+};
+
+/// The size of a transparent huge page on x86-64 and most ARM64 Linux kernels.
+const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+/// Asks the operating system to back the pages of `buffer` with huge pages where it is available.
+/// Only the pages that lie entirely within `buffer` are affected.
+/// This is only a hint and does nothing on platforms without transparent huge pages.
+void advise_huge_pages(std::span<std::byte> buffer);
+
+/// Allocates an uninitialized output buffer from `resource` with the alignment and huge page settings from `options`.
+/// The pages are not touched, so the threads that swizzle into the buffer fault them in.
+SwizzleBuffer output_buffer(size_t size, std::pmr::memory_resource* resource, const SwizzleOptions& options);
@@ -0,0 +1,156 @@
+#include <tegra_swizzle/lib.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pins `thread` to a single logical CPU.
+// Affinity is only a performance hint, so failures are ignored.
+static void set_cpu_affinity(std::thread& thread, size_t cpu) {
+#if defined(__linux__)
+    if (cpu < CPU_SETSIZE) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+    }
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+SwizzleContext::SwizzleContext(const SwizzleContextOptions& options) {
+    // Never use instructions the CPU does not support.
+    const SimdLevel detected = detect_simd_level();
+    _simd_level = options.simd_level.has_value() ? std::min(options.simd_level.value(), detected) : detected;
+    _kernels = gob_kernels_for(_simd_level);
+
+    SwizzleOptions thread_options;
+    thread_options.thread_count = options.thread_count;
+    const size_t worker_count = resolved_thread_count(thread_options) - 1;
+
+    _workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        _workers.emplace_back([this]() { worker_loop(); });
+        if (!options.cpu_affinity.empty()) {
+            set_cpu_affinity(_workers.back(), options.cpu_affinity[i % options.cpu_affinity.size()]);
+        }
+    }
+}
+
+SwizzleContext::~SwizzleContext() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _job_ready.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void SwizzleContext::run(size_t count, size_t thread_count, void (*task)(void* data, size_t i), void* data) {
+    auto work = [&]() {
+        for (size_t i = _next_index.fetch_add(1); i < count; i = _next_index.fetch_add(1)) {
+            task(data, i);
+        }
+    };
+
+    // The calling thread always works on the task, so only the remaining threads are helpers.
+    const size_t max_threads = std::min({ thread_count, count, _workers.size() + 1 });
+    const size_t helper_count = max_threads > 1 ? max_threads - 1 : 0;
+
+    std::unique_lock<std::mutex> run_lock(_run_mutex, std::try_to_lock);
+    if (helper_count == 0 || !run_lock.owns_lock()) {
+        for (size_t i = 0; i < count; ++i) {
+            task(data, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = task;
+        _task_data = data;
+        _task_count = count;
+        _next_index.store(0);
+        _helpers_wanted = helper_count;
+        _generation += 1;
+    }
+    _job_ready.notify_all();
+
+    work();
+
+    // Workers that have not started yet would find no indices left, so stop handing out the job.
+    std::unique_lock<std::mutex> lock(_mutex);
+    _helpers_wanted = 0;
+    _job_done.wait(lock, [&]() { return _helpers_running == 0; });
+}
+
+bool SwizzleContext::post(void (*task)(void* data), void* data) {
+    if (_workers.empty()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _posted.push_back(PostedTask{ task, data });
+    }
+    _job_ready.notify_one();
+    return true;
+}
+
+void SwizzleContext::worker_loop() {
+    uint64_t seen_generation = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _job_ready.wait(lock, [&]() {
+            return _stop
+                || (_generation != seen_generation && _helpers_wanted > 0)
+                || (!_posted_running && !_posted.empty());
+        });
+
+        // Helping a running call takes priority over starting a posted task.
+        const bool help = !_stop && _generation != seen_generation && _helpers_wanted > 0;
+        if (!help && !_posted_running && !_posted.empty()) {
+            const PostedTask posted = _posted.front();
+            _posted.pop_front();
+            _posted_running = true;
+            lock.unlock();
+
+            posted.task(posted.data);
+
+            lock.lock();
+            _posted_running = false;
+            lock.unlock();
+            // Wake a worker for the next posted task, since this worker may be needed as a helper.
+            _job_ready.notify_one();
+            continue;
+        }
+        if (!help) {
+            return;
+        }
+
+        seen_generation = _generation;
+        _helpers_wanted -= 1;
+        _helpers_running += 1;
+        void (*task)(void* data, size_t i) = _task;
+        void* data = _task_data;
+        const size_t count = _task_count;
+        lock.unlock();
+
+        for (size_t i = _next_index.fetch_add(1); i < count; i = _next_index.fetch_add(1)) {
+            task(data, i);
+        }
+
+        lock.lock();
+        _helpers_running -= 1;
+        if (_helpers_running == 0) {
+            lock.unlock();
+            _job_done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/kernels.h>
+#include <tegra_swizzle/options.h>
+#include <tegra_swizzle/parallel.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/// An interface for running the parallel work of the swizzle functions on an existing thread pool.
+/// Set [SwizzleOptions::executor] to use the executor instead of the threads of the library.
+class SwizzleExecutor {
+public:
+    virtual ~SwizzleExecutor() = default;
+
+    /// The number of calls the executor can run at the same time.
+    /// This is the thread count for a [SwizzleOptions::thread_count] of 0.
+    virtual size_t concurrency() const = 0;
+
+    /// Calls `task(data, i)` once for each i in 0..count and returns after every call has finished.
+    /// Calls may run in any order on any threads, including the calling thread.
+    /// A call only waits for calls that have already started,
+    /// so running the calls one at a time is also valid.
+    virtual void execute(size_t count, void (*task)(void* data, size_t i), void* data) = 0;
+
+    /// Calls `task(data)` once on a thread of the executor and returns without waiting for it.
+    /// The task may call [execute] for its own parallel work.
+    /// Returns `false` without calling `task` if the executor cannot run background work.
+    /// The default implementation always returns `false`, so the library starts its own thread instead.
+    virtual bool post(void (*task)(void* data), void* data) {
+        (void)task;
+        (void)data;
+        return false;
+    }
+};
+
+/// Settings for creating a [SwizzleContext].
+struct SwizzleContextOptions {
+    /// The number of threads including the calling thread.
+    /// The context starts one less than this many worker threads.
+    /// Use 0 to use one thread for each hardware thread.
+    size_t thread_count = 0;
+
+    /// The logical CPUs to pin the worker threads to.
+    /// Worker `i` runs on CPU `cpu_affinity[i % cpu_affinity.size()]`.
+    /// Leave empty to let the operating system schedule the workers.
+    /// Only supported on Linux and ignored on other platforms.
+    std::vector<size_t> cpu_affinity;
+
+    /// The widest instruction set to use for the complete GOB kernels.
+    /// Levels not supported by the CPU are lowered to the result of [detect_simd_level].
+    /// Use [None] to detect the level once when creating the context.
+    std::optional<SimdLevel> simd_level = std::nullopt;
+};
+
+/// Long lived state shared by any number of swizzle calls.
+///
+/// Create a context once per process or per worker and set [SwizzleOptions::context] to reuse it.
+/// The context keeps its worker threads running between calls,
+/// so small surfaces can be split across threads without paying for thread creation on each call.
+/// The kernel table and scratch memory for temporary allocations are also created once.
+///
+/// A context can be shared by multiple threads.
+/// Only one call at a time uses the worker threads.
+/// Overlapping calls run on their calling thread instead of waiting for the workers.
+/// The context must outlive every call that uses it.
+class SwizzleContext {
+public:
+    explicit SwizzleContext(const SwizzleContextOptions& options = SwizzleContextOptions());
+    ~SwizzleContext();
+
+    SwizzleContext(const SwizzleContext&) = delete;
+    SwizzleContext& operator=(const SwizzleContext&) = delete;
+
+    /// The number of threads including the calling thread.
+    size_t thread_count() const { return _workers.size() + 1; }
+
+    /// The selected instruction set for [kernels].
+    SimdLevel simd_level() const { return _simd_level; }
+
+    /// The complete GOB functions for [simd_level].
+    const GobKernels& kernels() const { return _kernels; }
+
+    /// Thread safe memory for temporary allocations made while swizzling.
+    /// Freed memory is pooled and reused by later calls instead of returning to the system.
+    std::pmr::memory_resource* scratch() { return &_scratch; }
+
+    /// Calls `task(data, i)` for each i in 0..count using up to `thread_count` threads including the calling thread.
+    /// Each index is claimed by exactly one thread.
+    /// Runs everything on the calling thread if the workers are already in use by another call.
+    void run(size_t count, size_t thread_count, void (*task)(void* data, size_t i), void* data);
+
+    /// Calls `task(data)` on one of the worker threads and returns without waiting for it.
+    /// Posted tasks run one at a time in the order they were posted,
+    /// and their parallel work is split across the remaining workers.
+    /// Returns `false` without calling `task` if the context has no worker threads.
+    /// Pending tasks still run when the context is destroyed.
+    bool post(void (*task)(void* data), void* data);
+
+private:
+    struct PostedTask {
+        void (*task)(void* data);
+        void* data;
+    };
+
+    void worker_loop();
+
+    std::vector<std::thread> _workers;
+    SimdLevel _simd_level;
+    GobKernels _kernels;
+    std::pmr::synchronized_pool_resource _scratch;
+
+    // Held for the duration of a call to run that uses the workers.
+    std::mutex _run_mutex;
+
+    // Protects the job description and worker counts below.
+    std::mutex _mutex;
+    std::condition_variable _job_ready;
+    std::condition_variable _job_done;
+    uint64_t _generation = 0;
+    size_t _helpers_wanted = 0;
+    size_t _helpers_running = 0;
+    bool _stop = false;
+
+    void (*_task)(void* data, size_t i) = nullptr;
+    void* _task_data = nullptr;
+    size_t _task_count = 0;
+    std::atomic<size_t> _next_index{ 0 };
+
+    // Background tasks from post that have not started yet.
+    std::deque<PostedTask> _posted;
+    bool _posted_running = false;
+};
+
+/// Returns the number of threads to use for the given options.
+/// A [SwizzleOptions::thread_count] of 0 uses the concurrency of [SwizzleOptions::executor]
+/// or every thread of [SwizzleOptions::context] if present.
+inline size_t resolved_thread_count(const SwizzleOptions& options) {
+    if (options.thread_count == 0) {
+        if (options.executor != nullptr) {
+            return std::max(options.executor->concurrency(), (size_t)1);
+        }
+        if (options.context != nullptr) {
+            return options.context->thread_count();
+        }
+        return std::max(static_cast<size_t>(std::thread::hardware_concurrency()), (size_t)1);
+    }
+
+    return options.thread_count;
+}
+
+/// The complete GOB functions from [SwizzleOptions::context] or for the current CPU if there is no context.
+inline const GobKernels& gob_kernels(const SwizzleOptions& options) {
+    return options.context != nullptr ? options.context->kernels() : gob_kernels();
+}
+
+/// Memory for temporary allocations from [SwizzleOptions::context] or the default resource if there is no context.
+inline std::pmr::memory_resource* scratch_resource(const SwizzleOptions& options) {
+    return options.context != nullptr ? options.context->scratch() : std::pmr::get_default_resource();
+}
+
+// Calls f(i) for each i in 0..count like parallel_for
+// but on [SwizzleOptions::executor] or the worker threads of [SwizzleOptions::context] if present.
+template <typename F>
+void parallel_for(size_t count, size_t thread_count, const SwizzleOptions& options, F f) {
+    if (options.executor != nullptr && thread_count > 1 && count > 1) {
+        // Hand out indices dynamically, so the executor only runs one call per thread.
+        std::atomic<size_t> next_index{ 0 };
+        auto worker = [&](size_t) {
+            for (size_t i = next_index.fetch_add(1); i < count; i = next_index.fetch_add(1)) {
+                f(i);
+            }
+        };
+        auto task = [](void* data, size_t i) { (*static_cast<decltype(worker)*>(data))(i); };
+        options.executor->execute(std::min(thread_count, count), task, &worker);
+    }
+    else if (options.context != nullptr) {
+        auto task = [](void* data, size_t i) { (*static_cast<F*>(data))(i); };
+        options.context->run(count, thread_count, task, &f);
+    }
+    else {
+        parallel_for(count, thread_count, f);
+    }
+}
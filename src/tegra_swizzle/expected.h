@@ -0,0 +1,92 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <new>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_expected)
+#include <expected>
+#endif
+
+// The noexcept try_ functions return either a value or the [SwizzleErrorInfo] for why they failed.
+// This uses std::expected when it is available and a minimal replacement with the same interface otherwise.
+
+#if defined(__cpp_lib_expected)
+
+/// The result of a function that can fail with a [SwizzleErrorInfo].
+template <typename T>
+using SwizzleExpected = std::expected<T, SwizzleErrorInfo>;
+
+/// Converts a [SwizzleErrorInfo] to a failed [SwizzleExpected].
+using SwizzleUnexpected = std::unexpected<SwizzleErrorInfo>;
+
+#else
+
+/// Converts a [SwizzleErrorInfo] to a failed [SwizzleExpected].
+class SwizzleUnexpected {
+public:
+    explicit SwizzleUnexpected(SwizzleErrorInfo error) noexcept : _error(error) {}
+
+    const SwizzleErrorInfo& error() const noexcept { return _error; }
+
+private:
+    SwizzleErrorInfo _error;
+};
+
+/// The result of a function that can fail with a [SwizzleErrorInfo].
+/// C++ port: This replaces std::expected for standard libraries without C++23 support.
+/// Accessing the value of a failed result is undefined rather than throwing.
+template <typename T>
+class SwizzleExpected {
+public:
+    SwizzleExpected(T value) noexcept : _value(std::move(value)) {}
+    SwizzleExpected(SwizzleUnexpected error) noexcept : _error(error.error()) {}
+
+    bool has_value() const noexcept { return _value.has_value(); }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    T& value() & noexcept { return *_value; }
+    const T& value() const& noexcept { return *_value; }
+    T&& value() && noexcept { return std::move(*_value); }
+
+    T& operator*() & noexcept { return *_value; }
+    const T& operator*() const& noexcept { return *_value; }
+    T&& operator*() && noexcept { return std::move(*_value); }
+
+    T* operator->() noexcept { return &*_value; }
+    const T* operator->() const noexcept { return &*_value; }
+
+    /// The error for a failed result.
+    const SwizzleErrorInfo& error() const noexcept { return _error; }
+
+private:
+    std::optional<T> _value;
+    SwizzleErrorInfo _error = {};
+};
+
+#endif
+
+// Calls `f` and converts failures to allocate memory or start threads to [SwizzleError::OutOfResources],
+// so the noexcept try_ functions report them instead of terminating.
+// `f` must return a [SwizzleExpected].
+template <typename F>
+auto catch_resource_errors(F f) noexcept -> decltype(f()) {
+#if defined(TEGRA_SWIZZLE_EXCEPTIONS)
+    try {
+        return f();
+    }
+    catch (const std::bad_alloc&) {
+    }
+    catch (const std::system_error&) {
+    }
+    return SwizzleUnexpected(SwizzleErrorInfo{ SwizzleError::OutOfResources, 0, 0 });
+#else
+    return f();
+#endif
+}
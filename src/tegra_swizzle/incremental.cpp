@@ -0,0 +1,106 @@
+#include <tegra_swizzle/lib.h>
+
+IncrementalDeswizzler::IncrementalDeswizzler(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+)
+    : _options(options), _row_buffer(scratch_resource(options)) {
+    if (destination.size() < deswizzled_mip_size(width, height, depth, bytes_per_pixel)) {
+        throw_runtime_error("Destination is too small!");
+    }
+
+    const size_t _block_depth = block_depth(depth);
+
+    // Tasks must cover rows of blocks in the order they are stored in the swizzled data.
+    // Each task covers every depth slice of a block in the swizzled order.
+    if (_block_depth > 1) {
+        _options.traversal_order = TraversalOrder::Swizzled;
+    }
+
+    _swizzled_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
+    _row_size = GOB_SIZE_IN_BYTES * static_cast<size_t>(block_height) * _block_depth * width_in_gobs(width, bytes_per_pixel);
+
+    _work = mip_work<true>(
+        width,
+        height,
+        depth,
+        nullptr,
+        _swizzled_size,
+        reinterpret_cast<unsigned char*>(destination.data()),
+        destination.size(),
+        block_height,
+        _block_depth,
+        bytes_per_pixel,
+        _options
+    );
+
+    _row_buffer.resize(_row_size);
+}
+
+void IncrementalDeswizzler::push(std::span<const std::byte> data) {
+    data = data.first(std::min(data.size(), _swizzled_size - _received_size));
+    if (data.empty()) {
+        return;
+    }
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    size_t remaining = data.size();
+
+    // Finish the row of blocks split between the previous chunks and this chunk.
+    if (_buffered_size > 0) {
+        const size_t size = std::min(remaining, _row_size - _buffered_size);
+        std::copy(bytes, bytes + size, _row_buffer.data() + _buffered_size);
+        _buffered_size += size;
+        _received_size += size;
+        bytes += size;
+        remaining -= size;
+
+        if (_buffered_size < _row_size) {
+            return;
+        }
+
+        deswizzle_rows(_row_buffer.data(), _completed_rows * _row_size, _completed_rows, _completed_rows + 1);
+        _completed_rows += 1;
+        _buffered_size = 0;
+    }
+
+    // Deswizzle complete rows of blocks in place without copying.
+    const size_t row_count = remaining / _row_size;
+    if (row_count > 0) {
+        deswizzle_rows(bytes, _received_size, _completed_rows, _completed_rows + row_count);
+        _completed_rows += row_count;
+        _received_size += row_count * _row_size;
+        bytes += row_count * _row_size;
+        remaining -= row_count * _row_size;
+    }
+
+    // Keep the start of the next row of blocks for later chunks.
+    std::copy(bytes, bytes + remaining, _row_buffer.data());
+    _buffered_size = remaining;
+    _received_size += remaining;
+}
+
+void IncrementalDeswizzler::deswizzle_rows(const unsigned char* source, size_t source_offset, size_t row_start, size_t row_end) {
+    // The tasks only read the swizzled data of their own rows,
+    // so `source` can start at the swizzled offset of the first row.
+    _work.source = source;
+    _work.swizzled_origin = source_offset;
+
+    const size_t row_count = row_end - row_start;
+    const bool parallel = row_count * _row_size >= _options.parallel_threshold_in_bytes;
+    const size_t thread_count = parallel ? std::min(resolved_thread_count(_options), row_count) : 1;
+
+    if (thread_count > 1) {
+        parallel_for(thread_count, thread_count, _options, [&](size_t i) {
+            _work.run(_work, row_start + i * row_count / thread_count, row_start + (i + 1) * row_count / thread_count);
+        });
+    }
+    else {
+        _work.run(_work, row_start, row_end);
+    }
+}
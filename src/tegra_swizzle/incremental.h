@@ -0,0 +1,75 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/swizzle.h>
+#include <memory_resource>
+#include <span>
+#include <vector>
+#include <cstddef>
+
+//! Deswizzling a mipmap while its swizzled data is still arriving.
+//!
+//! Swizzled mipmaps are stored one row of blocks at a time,
+//! so each row of blocks can be deswizzled as soon as all of its bytes are available.
+//! Push chunks from a network stream or decompressor into an [IncrementalDeswizzler]
+//! to overlap reading the data with deswizzling it instead of waiting for the entire mipmap.
+
+/// Deswizzles a single mipmap from swizzled data that is pushed in chunks of any size.
+///
+/// Complete rows of blocks are deswizzled directly from the pushed chunks.
+/// Only the bytes of a row of blocks split between chunks are copied into an internal buffer,
+/// so the memory used is at most a single row of blocks.
+class IncrementalDeswizzler {
+public:
+    /// Creates a deswizzler for the mipmap with the given dimensions like [deswizzle_block_linear]
+    /// that writes into the caller provided `destination`.
+    /// The thread settings from `options` are used to split large chunks across threads.
+    /// 3D mipmaps always use [TraversalOrder::Swizzled], since the other orders do not finish rows of blocks in swizzled order.
+    ///
+    /// `destination` must outlive the deswizzler.
+    /// Throws if `destination` has fewer bytes than [deswizzled_mip_size].
+    IncrementalDeswizzler(
+        size_t width,
+        size_t height,
+        size_t depth,
+        BlockHeight block_height,
+        size_t bytes_per_pixel,
+        std::span<std::byte> destination,
+        const SwizzleOptions& options = SwizzleOptions()
+    );
+
+    /// Appends the next bytes of the swizzled mipmap and deswizzles every row of blocks that is now complete.
+    /// Bytes after the first [swizzled_size] bytes are ignored.
+    /// `data` can be reused by the caller after this returns.
+    void push(std::span<const std::byte> data);
+
+    /// The number of bytes received so far excluding ignored bytes.
+    size_t received_size() const { return _received_size; }
+
+    /// The total number of swizzled bytes for the mipmap from [swizzled_mip_size].
+    size_t swizzled_size() const { return _swizzled_size; }
+
+    /// The number of rows of blocks that have been written to the destination.
+    /// For 2D mipmaps, the first `completed_rows() * block_height * 8` rows of the destination are complete.
+    size_t completed_rows() const { return _completed_rows; }
+
+    /// The total number of rows of blocks in all depth slices.
+    size_t row_count() const { return _work.task_count; }
+
+    /// Returns `true` if every row of blocks has been written to the destination.
+    bool done() const { return _completed_rows == _work.task_count; }
+
+private:
+    void deswizzle_rows(const unsigned char* source, size_t source_offset, size_t row_start, size_t row_end);
+
+    MipWork _work;
+    SwizzleOptions _options;
+    size_t _swizzled_size;
+    // The swizzled size of a row of blocks including all the depth slices of a block.
+    size_t _row_size;
+    size_t _received_size = 0;
+    size_t _completed_rows = 0;
+    // The bytes received so far for the next incomplete row of blocks.
+    std::pmr::vector<unsigned char> _row_buffer;
+    size_t _buffered_size = 0;
+};
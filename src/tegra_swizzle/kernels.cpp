@@ -0,0 +1,52 @@
+#include <tegra_swizzle/lib.h>
+
+SimdLevel detect_simd_level() {
+#if defined(TEGRA_SWIZZLE_X86)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+
+    // The OS must save the YMM and ZMM registers on context switches.
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool os_ymm = (xcr0 & 0x6) == 0x6;
+    const bool os_zmm = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false;
+    bool avx512f = false;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512f = (info[1] & (1 << 16)) != 0;
+    }
+
+    if (avx512f && os_zmm) {
+        return SimdLevel::AVX512;
+    }
+    if (avx && avx2 && os_ymm) {
+        return SimdLevel::AVX2;
+    }
+    if (sse2) {
+        return SimdLevel::SSE2;
+    }
+#else
+    // The builtins also check that the OS has enabled the wider registers.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+#endif
+    return SimdLevel::Scalar;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+// Hand written SIMD versions of the complete GOB functions in swizzle.h.
+// Each kernel moves an entire 64x8 GOB between the 512 contiguous swizzled bytes
+// and the 64 byte wide rows of the deswizzled region.
+//
+// The swizzled GOB stores two rows of 16 byte sectors next to each other.
+// Deswizzled rows 2k and 2k + 1 are found in the 64 bytes at swizzled offset 64k
+// for columns 0..32 and in the 64 bytes at swizzled offset 256 + 64k for columns 32..64.
+// Within each 64 bytes, the 16 byte sectors are ordered row 2k, row 2k + 1, row 2k, row 2k + 1.
+//
+// The kernels are compiled with function level target attributes rather than global compiler flags,
+// so a single binary can pick the best kernel at runtime with [detect_simd_level].
+// Each instruction set has its own source file, kernels_sse2.cpp, kernels_avx2.cpp, and kernels_avx512.cpp,
+// that explicitly instantiates the regular and streaming versions of its kernels.
+// Avoid compiling those files with flags like -mavx2 instead,
+// since the linker may then pick their copies of shared inline functions for the whole program.
+//
+// Each kernel has a streaming version for surfaces much larger than the last level cache.
+// The streaming versions write with non-temporal stores that bypass the cache,
+// so the write once output does not evict the input that is still being read.
+// Non-temporal stores require destinations aligned to the vector size
+// and a [stream_fence] before other threads read the results.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TEGRA_SWIZZLE_X86 1
+#endif
+
+#if defined(TEGRA_SWIZZLE_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TEGRA_SWIZZLE_TARGET(x) __attribute__((target(x)))
+#else
+#define TEGRA_SWIZZLE_TARGET(x)
+#endif
+
+/// The instruction sets with dedicated complete GOB kernels.
+/// Later values are supersets of earlier values.
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+/// Returns the widest [SimdLevel] supported by both the CPU and the operating system.
+SimdLevel detect_simd_level();
+
+/// A function that swizzles or deswizzles a single complete GOB.
+using CompleteGobFn = void (*)(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+/// The complete GOB functions for a particular [SimdLevel].
+struct GobKernels {
+    CompleteGobFn deswizzle;
+    CompleteGobFn swizzle;
+    /// Versions of [deswizzle] and [swizzle] with non-temporal stores.
+    CompleteGobFn stream_deswizzle;
+    CompleteGobFn stream_swizzle;
+    /// The required alignment in bytes of every destination row for the streaming functions.
+    size_t stream_alignment;
+};
+
+/// Prefetches the 8 cache lines starting at `src` that are `row_size_in_bytes` apart.
+/// Use a `row_size_in_bytes` of 64 for the contiguous 512 bytes of a swizzled GOB.
+inline void prefetch_gob(const unsigned char* src, size_t row_size_in_bytes) {
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; ++i) {
+#if defined(TEGRA_SWIZZLE_X86)
+        _mm_prefetch(reinterpret_cast<const char*>(src + row_size_in_bytes * i), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(src + row_size_in_bytes * i);
+#endif
+    }
+}
+
+/// Orders the non-temporal stores of the calling thread before any later stores.
+/// Call this after the streaming kernels and before publishing the results to other threads.
+inline void stream_fence() {
+#if defined(TEGRA_SWIZZLE_X86)
+    _mm_sfence();
+#endif
+}
+
+#if defined(TEGRA_SWIZZLE_X86)
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("sse2")
+void deswizzle_complete_gob_sse2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("sse2")
+void swizzle_complete_gob_sse2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx2")
+void deswizzle_complete_gob_avx2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx2")
+void swizzle_complete_gob_avx2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx512f")
+void deswizzle_complete_gob_avx512(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx512f")
+void swizzle_complete_gob_avx512(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+#endif
@@ -0,0 +1,66 @@
+// The AVX2 complete GOB kernels declared in kernels.h.
+#include <tegra_swizzle/lib.h>
+
+#if defined(TEGRA_SWIZZLE_X86)
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx2")
+void store_256(unsigned char* dst, __m256i value) {
+    if constexpr (STREAM) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), value);
+    }
+    else {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+    }
+}
+
+// 32 byte loads contain the same 16 byte column range for two rows.
+// Swapping the 128-bit lanes of two loads gives 32 contiguous bytes of each row.
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx2")
+void deswizzle_complete_gob_avx2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        const unsigned char* s0 = src + i * 32;
+        const unsigned char* s1 = s0 + 256;
+        unsigned char* d0 = dst + row_size_in_bytes * i;
+        unsigned char* d1 = d0 + row_size_in_bytes;
+
+        const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0));
+        const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + 32));
+        const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1));
+        const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + 32));
+
+        store_256<STREAM>(d0, _mm256_permute2x128_si256(a0, a1, 0x20));
+        store_256<STREAM>(d0 + 32, _mm256_permute2x128_si256(b0, b1, 0x20));
+        store_256<STREAM>(d1, _mm256_permute2x128_si256(a0, a1, 0x31));
+        store_256<STREAM>(d1 + 32, _mm256_permute2x128_si256(b0, b1, 0x31));
+    }
+}
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx2")
+void swizzle_complete_gob_avx2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        unsigned char* d0 = dst + i * 32;
+        unsigned char* d1 = d0 + 256;
+        const unsigned char* s0 = src + row_size_in_bytes * i;
+        const unsigned char* s1 = s0 + row_size_in_bytes;
+
+        const __m256i r00 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0));
+        const __m256i r01 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s0 + 32));
+        const __m256i r10 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1));
+        const __m256i r11 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + 32));
+
+        store_256<STREAM>(d0, _mm256_permute2x128_si256(r00, r10, 0x20));
+        store_256<STREAM>(d0 + 32, _mm256_permute2x128_si256(r00, r10, 0x31));
+        store_256<STREAM>(d1, _mm256_permute2x128_si256(r01, r11, 0x20));
+        store_256<STREAM>(d1 + 32, _mm256_permute2x128_si256(r01, r11, 0x31));
+    }
+}
+
+template void deswizzle_complete_gob_avx2<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void deswizzle_complete_gob_avx2<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_avx2<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_avx2<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+#endif
@@ -0,0 +1,56 @@
+// The AVX-512 complete GOB kernels declared in kernels.h.
+#include <tegra_swizzle/lib.h>
+
+#if defined(TEGRA_SWIZZLE_X86)
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx512f")
+void store_512(unsigned char* dst, __m512i value) {
+    if constexpr (STREAM) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(dst), value);
+    }
+    else {
+        _mm512_storeu_si512(dst, value);
+    }
+}
+
+// 64 byte loads contain half of two rows.
+// Combining the even or odd 128-bit lanes of two loads gives an entire row.
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx512f")
+void deswizzle_complete_gob_avx512(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    // Lanes 0, 2 of a followed by lanes 0, 2 of b and similarly for lanes 1, 3.
+    const __m512i even = _mm512_set_epi64(13, 12, 9, 8, 5, 4, 1, 0);
+    const __m512i odd = _mm512_set_epi64(15, 14, 11, 10, 7, 6, 3, 2);
+
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        const __m512i a = _mm512_loadu_si512(src + i * 32);
+        const __m512i b = _mm512_loadu_si512(src + i * 32 + 256);
+
+        store_512<STREAM>(dst + row_size_in_bytes * i, _mm512_permutex2var_epi64(a, even, b));
+        store_512<STREAM>(dst + row_size_in_bytes * (i + 1), _mm512_permutex2var_epi64(a, odd, b));
+    }
+}
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("avx512f")
+void swizzle_complete_gob_avx512(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    // Interleave the 128-bit lanes of both rows.
+    const __m512i lo = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+    const __m512i hi = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        const __m512i r0 = _mm512_loadu_si512(src + row_size_in_bytes * i);
+        const __m512i r1 = _mm512_loadu_si512(src + row_size_in_bytes * (i + 1));
+
+        store_512<STREAM>(dst + i * 32, _mm512_permutex2var_epi64(r0, lo, r1));
+        store_512<STREAM>(dst + i * 32 + 256, _mm512_permutex2var_epi64(r0, hi, r1));
+    }
+}
+
+template void deswizzle_complete_gob_avx512<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void deswizzle_complete_gob_avx512<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_avx512<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_avx512<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+#endif
@@ -0,0 +1,82 @@
+// The SSE2 complete GOB kernels declared in kernels.h.
+#include <tegra_swizzle/lib.h>
+
+#if defined(TEGRA_SWIZZLE_X86)
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("sse2")
+void store_128(unsigned char* dst, __m128i value) {
+    if constexpr (STREAM) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dst), value);
+    }
+    else {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+    }
+}
+
+// 16 byte loads and stores for each sector.
+// This is what the scalar version hopes the compiler generates.
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("sse2")
+void deswizzle_complete_gob_sse2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        const unsigned char* s0 = src + i * 32;
+        const unsigned char* s1 = s0 + 256;
+        unsigned char* d0 = dst + row_size_in_bytes * i;
+        unsigned char* d1 = d0 + row_size_in_bytes;
+
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0));
+        const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 16));
+        const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 32));
+        const __m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 48));
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 16));
+        const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 32));
+        const __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 48));
+
+        store_128<STREAM>(d0, a0);
+        store_128<STREAM>(d0 + 16, a2);
+        store_128<STREAM>(d0 + 32, b0);
+        store_128<STREAM>(d0 + 48, b2);
+        store_128<STREAM>(d1, a1);
+        store_128<STREAM>(d1 + 16, a3);
+        store_128<STREAM>(d1 + 32, b1);
+        store_128<STREAM>(d1 + 48, b3);
+    }
+}
+
+template <bool STREAM>
+TEGRA_SWIZZLE_TARGET("sse2")
+void swizzle_complete_gob_sse2(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; i += 2) {
+        unsigned char* d0 = dst + i * 32;
+        unsigned char* d1 = d0 + 256;
+        const unsigned char* s0 = src + row_size_in_bytes * i;
+        const unsigned char* s1 = s0 + row_size_in_bytes;
+
+        const __m128i r00 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0));
+        const __m128i r01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 16));
+        const __m128i r02 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 32));
+        const __m128i r03 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 48));
+        const __m128i r10 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1));
+        const __m128i r11 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 16));
+        const __m128i r12 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 32));
+        const __m128i r13 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 48));
+
+        store_128<STREAM>(d0, r00);
+        store_128<STREAM>(d0 + 16, r10);
+        store_128<STREAM>(d0 + 32, r01);
+        store_128<STREAM>(d0 + 48, r11);
+        store_128<STREAM>(d1, r02);
+        store_128<STREAM>(d1 + 16, r12);
+        store_128<STREAM>(d1 + 32, r03);
+        store_128<STREAM>(d1 + 48, r13);
+    }
+}
+
+template void deswizzle_complete_gob_sse2<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void deswizzle_complete_gob_sse2<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_sse2<false>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+template void swizzle_complete_gob_sse2<true>(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes);
+
+#endif
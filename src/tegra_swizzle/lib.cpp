@@ -1 +0,0 @@
-#include <tegra_swizzle/lib.h>
\ No newline at end of file
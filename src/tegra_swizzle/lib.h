@@ -3,6 +3,9 @@
 #include <vector>
 #include <algorithm>
 #include <optional>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstddef>
 
 const size_t GOB_WIDTH_IN_BYTES = 64;
 const size_t GOB_HEIGHT_IN_BYTES = 8;
@@ -26,10 +29,69 @@ enum class BlockHeight {
 };
 
 /// Errors than can occur while swizzling or deswizzling.
+/// See [SwizzleErrorInfo] for the sizes that caused the error.
 enum class SwizzleError {
-    NotEnoughData // C++ port: The rust implementation defines member variables for each error with details. That's a little harder to do in C++ so I'm not doing it that way.
+    /// The source has fewer bytes than required.
+    NotEnoughData,
+    /// The caller provided destination has fewer bytes than required.
+    DestinationTooSmall,
+    /// Memory could not be allocated or threads could not be started.
+    /// The output is incomplete, and the sizes are always 0.
+    OutOfResources,
+    /// The work was stopped by [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] before it finished.
+    /// The output is incomplete, and the sizes are always 0.
+    Cancelled
 };
 
+/// A [SwizzleError] with the sizes that caused it.
+/// C++ port: The rust implementation stores these sizes in the error variants instead.
+struct SwizzleErrorInfo {
+    SwizzleError error;
+    /// The minimum size in bytes for the source or destination.
+    size_t expected_size;
+    /// The actual size in bytes of the source or destination.
+    size_t actual_size;
+};
+
+/// Returns the same message used for the exceptions thrown for `error`.
+inline const char* swizzle_error_message(SwizzleError error) {
+    switch (error) {
+    case SwizzleError::NotEnoughData:
+        return "Not enough data!";
+    case SwizzleError::DestinationTooSmall:
+        return "Destination is too small!";
+    case SwizzleError::OutOfResources:
+        return "Out of resources!";
+    case SwizzleError::Cancelled:
+        return "Cancelled!";
+    default:
+        return "Unknown error!";
+    }
+}
+
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+#define TEGRA_SWIZZLE_EXCEPTIONS 1
+#endif
+
+// Throws a std::runtime_error or aborts when compiling without exceptions.
+// Use the noexcept try_ functions to handle errors without exceptions.
+[[noreturn]] inline void throw_runtime_error(const char* message) {
+#if defined(TEGRA_SWIZZLE_EXCEPTIONS)
+    throw std::runtime_error(message);
+#else
+    (void)message;
+    std::abort();
+#endif
+}
+
+// Returns an error if `actual_size` is smaller than `expected_size`.
+inline std::optional<SwizzleErrorInfo> check_size(SwizzleError error, size_t expected_size, size_t actual_size) {
+    if (actual_size < expected_size) {
+        return SwizzleErrorInfo{ error, expected_size, actual_size };
+    }
+    return std::nullopt;
+}
+
 constexpr BlockHeight block_height_from_value(size_t value) {
     switch (value) {
     case 1:
@@ -73,11 +135,11 @@ constexpr size_t div_round_up(size_t x, size_t d) {
     return (x + d - 1) / d;
 }
 
-const size_t round_up(size_t x, size_t n) {
+constexpr size_t round_up(size_t x, size_t n) {
     return ((x + n - 1) / n) * n;
 }
 
-const size_t width_in_gobs(size_t width, size_t bytes_per_pixel) {
+constexpr size_t width_in_gobs(size_t width, size_t bytes_per_pixel) {
     return div_round_up(width * bytes_per_pixel, GOB_WIDTH_IN_BYTES);
 }
 
@@ -88,4 +150,12 @@ constexpr size_t height_in_blocks(size_t height, size_t block_height) {
 
 /// Just include these all here so stuff gets all linked up.
 /// Not a very complicated library setup.
-#include <tegra_swizzle/surface.h>
\ No newline at end of file
+#include <tegra_swizzle/surface.h>
+#include <tegra_swizzle/region.h>
+#include <tegra_swizzle/context.h>
+#include <tegra_swizzle/batch.h>
+#include <tegra_swizzle/scheduler.h>
+#include <tegra_swizzle/async.h>
+#include <tegra_swizzle/resumable.h>
+#include <tegra_swizzle/bands.h>
+#include <tegra_swizzle/incremental.h>
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stop_token>
+
+class SwizzleContext;
+class SwizzleExecutor;
+
+/// The order for visiting the GOBs of a mipmap.
+/// All orders produce the same result but access memory differently.
+enum class TraversalOrder {
+    /// Pick an order based on the swizzle direction and the size of the surface.
+    Auto,
+    /// Visit GOBs in deswizzled memory order by depth slice, row of GOBs, and then column of GOBs.
+    Linear,
+    /// Visit GOBs in swizzled memory order by block, depth slice within the block, and then GOB within the block.
+    Swizzled,
+    /// Visit all the GOBs in a block column before moving to the next block, one depth slice at a time.
+    BlockColumns
+};
+
+/// Settings that affect how the swizzle functions do their work but never the result.
+///
+/// The default options process everything on the calling thread.
+struct SwizzleOptions {
+    /// The maximum number of threads to use including the calling thread.
+    /// Use 0 to use one thread for each hardware thread.
+    size_t thread_count = 1;
+
+    /// Mipmaps with fewer deswizzled bytes than this are always processed on the calling thread.
+    /// Starting threads costs more than swizzling small mipmaps.
+    size_t parallel_threshold_in_bytes = 1 << 20;
+
+    /// Mipmaps with at least this many deswizzled bytes write their output with non-temporal stores
+    /// and prefetch their input.
+    /// This avoids evicting the input from the cache for surfaces much larger than the last level cache.
+    /// Use SIZE_MAX to always write through the cache.
+    size_t streaming_threshold_in_bytes = 64 << 20;
+
+    /// The order for visiting GOBs within each mipmap.
+    TraversalOrder traversal_order = TraversalOrder::Auto;
+
+    /// The alignment in bytes for buffers allocated by the swizzle functions.
+    /// An alignment of 64 aligns rows to cache lines, which also allows streaming stores for more surfaces.
+    size_t output_alignment = alignof(std::max_align_t);
+
+    /// Ask the operating system to back large allocated buffers with huge pages.
+    /// Buffers of at least [HUGE_PAGE_SIZE] bytes are also aligned to [HUGE_PAGE_SIZE].
+    bool huge_pages = false;
+
+    /// Fault in the output pages on the threads that write them before swizzling with more than one thread.
+    /// Each thread touches the tasks it is initially assigned, so the pages are placed on the memory node of that thread.
+    /// Only stolen tasks are written by a different thread.
+    /// This only helps for freshly allocated output like the buffers from the allocating functions.
+    bool first_touch = false;
+
+    /// Reuse the worker threads, kernel table, and scratch memory of an existing context.
+    /// Use nullptr to start new threads for each call that uses more than one thread.
+    /// See [SwizzleContext] for details.
+    SwizzleContext* context = nullptr;
+
+    /// Run parallel work on an existing thread pool instead of the threads of the library or [context].
+    /// Use nullptr to use [context] or start new threads.
+    /// See [SwizzleExecutor] for details.
+    SwizzleExecutor* executor = nullptr;
+
+    /// Stop working early once a stop is requested.
+    /// Threads check before each row of blocks or small range of rows, so a stop takes effect quickly.
+    /// Stopped calls fail with [SwizzleError::Cancelled] and leave the output incomplete.
+    std::stop_token stop_token;
+
+    /// Stop working early once this time has passed like for [stop_token].
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
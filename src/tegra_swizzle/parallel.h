@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// Calls f(i) for each i in 0..count using up to thread_count threads including the calling thread.
+// Each index is claimed by exactly one thread, so f must only write memory owned by its index.
+template <typename F>
+void parallel_for(size_t count, size_t thread_count, F f) {
+    const size_t worker_count = std::min(thread_count, count);
+    if (worker_count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    // Hand out indices dynamically since tasks along the edges do less work.
+    std::atomic<size_t> next_index{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next_index.fetch_add(1); i < count; i = next_index.fetch_add(1)) {
+            f(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(worker_count - 1);
+    for (size_t i = 0; i < worker_count - 1; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
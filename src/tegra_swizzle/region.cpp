@@ -0,0 +1,198 @@
+#include <tegra_swizzle/lib.h>
+
+// Checks that the region fits in the mipmap and the swizzled and linear buffers are large enough.
+static void validate_region(
+    size_t width,
+    size_t height,
+    size_t depth,
+    size_t swizzled_size,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    size_t linear_size,
+    size_t row_pitch,
+    size_t slice_pitch
+) {
+    if (region.x + region.width > width || region.y + region.height > height || region.z + region.depth > depth) {
+        throw_runtime_error("Region is outside the mipmap!");
+    }
+
+    if (swizzled_size < swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel)) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    if (region.width == 0 || region.height == 0 || region.depth == 0) {
+        return;
+    }
+
+    const size_t region_row_size = region.width * bytes_per_pixel;
+    if (row_pitch < region_row_size || (region.depth > 1 && slice_pitch < row_pitch * region.height)) {
+        throw_runtime_error("Pitch is smaller than the region!");
+    }
+
+    const size_t expected_size = (region.depth - 1) * slice_pitch + (region.height - 1) * row_pitch + region_row_size;
+    if (linear_size < expected_size) {
+        throw_runtime_error("Not enough data!");
+    }
+}
+
+// Swizzle or deswizzle only the GOBs of a mipmap that intersect `region`.
+// The swizzled data uses the full mipmap dimensions, and callers check that the region fits in the mipmap.
+// The linear data only contains the region with the given row and slice pitch.
+template <bool DESWIZZLE>
+void swizzle_region_inner(
+    size_t width,
+    size_t height,
+    const unsigned char* source,
+    unsigned char* destination,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    size_t row_pitch,
+    size_t slice_pitch,
+    const SwizzleOptions& options
+) {
+    const size_t _block_height = static_cast<size_t>(block_height);
+    const size_t _width_in_gobs = width_in_gobs(width, bytes_per_pixel);
+    const size_t _slice_size = slice_size(_block_height, block_depth, _width_in_gobs, height);
+
+    const size_t block_size_in_bytes = GOB_SIZE_IN_BYTES * _block_height * block_depth;
+    const size_t block_height_in_bytes = GOB_HEIGHT_IN_BYTES * _block_height;
+
+    const CompleteGobFn complete_gob = DESWIZZLE ? gob_kernels(options).deswizzle : gob_kernels(options).swizzle;
+
+    // The region in byte coordinates.
+    const size_t region_x_start = region.x * bytes_per_pixel;
+    const size_t region_x_end = (region.x + region.width) * bytes_per_pixel;
+    const size_t region_y_start = region.y;
+    const size_t region_y_end = region.y + region.height;
+
+    for (size_t z = region.z; z < region.z + region.depth; ++z) {
+        const size_t offset_z = gob_address_z(z, _block_height, block_depth, _slice_size);
+        const size_t linear_z = (z - region.z) * slice_pitch;
+
+        // Start from the GOB containing the first row and column of the region.
+        for (size_t y0 = region_y_start / GOB_HEIGHT_IN_BYTES * GOB_HEIGHT_IN_BYTES; y0 < region_y_end; y0 += GOB_HEIGHT_IN_BYTES) {
+            const size_t offset_y = gob_address_y(y0, block_height_in_bytes, block_size_in_bytes, _width_in_gobs);
+
+            const size_t y_start = std::max(region_y_start, y0);
+            const size_t y_end = std::min(region_y_end, y0 + GOB_HEIGHT_IN_BYTES);
+
+            for (size_t x0 = region_x_start / GOB_WIDTH_IN_BYTES * GOB_WIDTH_IN_BYTES; x0 < region_x_end; x0 += GOB_WIDTH_IN_BYTES) {
+                const size_t gob_address = offset_z + offset_y + gob_address_x(x0, block_size_in_bytes);
+
+                const size_t x_start = std::max(region_x_start, x0);
+                const size_t x_end = std::min(region_x_end, x0 + GOB_WIDTH_IN_BYTES);
+
+                const size_t linear_offset = linear_z
+                    + (y_start - region_y_start) * row_pitch
+                    + (x_start - region_x_start);
+
+                if (x_end - x_start == GOB_WIDTH_IN_BYTES && y_end - y_start == GOB_HEIGHT_IN_BYTES) {
+                    if (DESWIZZLE) {
+                        complete_gob(destination + linear_offset, source + gob_address, row_pitch);
+                    }
+                    else {
+                        complete_gob(destination + gob_address, source + linear_offset, row_pitch);
+                    }
+                }
+                else {
+                    swizzle_deswizzle_gob_rect<DESWIZZLE>(
+                        destination,
+                        source,
+                        gob_address,
+                        linear_offset,
+                        row_pitch,
+                        x_start - x0,
+                        x_end - x0,
+                        y_start - y0,
+                        y_end - y0
+                    );
+                }
+            }
+        }
+    }
+}
+
+void deswizzle_block_linear_region(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    std::span<std::byte> destination,
+    size_t row_pitch,
+    size_t slice_pitch,
+    const SwizzleOptions& options
+) {
+    validate_region(
+        width,
+        height,
+        depth,
+        source.size(),
+        block_height,
+        bytes_per_pixel,
+        region,
+        destination.size(),
+        row_pitch,
+        slice_pitch
+    );
+
+    swizzle_region_inner<true>(
+        width,
+        height,
+        reinterpret_cast<const unsigned char*>(source.data()),
+        reinterpret_cast<unsigned char*>(destination.data()),
+        block_height,
+        block_depth(depth),
+        bytes_per_pixel,
+        region,
+        row_pitch,
+        slice_pitch,
+        options
+    );
+}
+
+void swizzle_block_linear_region(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    size_t row_pitch,
+    size_t slice_pitch,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+) {
+    validate_region(
+        width,
+        height,
+        depth,
+        destination.size(),
+        block_height,
+        bytes_per_pixel,
+        region,
+        source.size(),
+        row_pitch,
+        slice_pitch
+    );
+
+    swizzle_region_inner<false>(
+        width,
+        height,
+        reinterpret_cast<const unsigned char*>(source.data()),
+        reinterpret_cast<unsigned char*>(destination.data()),
+        block_height,
+        block_depth(depth),
+        bytes_per_pixel,
+        region,
+        row_pitch,
+        slice_pitch,
+        options
+    );
+}
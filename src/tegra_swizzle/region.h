@@ -0,0 +1,71 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/swizzle.h>
+#include <span>
+#include <cstddef>
+#include <stdexcept>
+
+//! Functions for reading or writing a box of blocks within a single swizzled mipmap.
+//!
+//! Only the GOBs that intersect the box are accessed,
+//! so the cost scales with the size of the box rather than the size of the mipmap.
+
+/// A box within a mipmap.
+/// Coordinates and dimensions are in blocks, so uncompressed formats like R8G8B8A8 use pixels
+/// and compressed formats like BC7 divide the pixel values by the block dimensions.
+struct MipRegion {
+    size_t x;
+    size_t y;
+    size_t z;
+    size_t width;
+    size_t height;
+    size_t depth;
+};
+
+/// Deswizzles only the blocks in `region` from the swizzled mipmap `source` into `destination`.
+/// The dimensions describe the entire mipmap like for [deswizzle_block_linear].
+///
+/// Rows of the region are written `row_pitch` bytes apart and depth slices `slice_pitch` bytes apart.
+/// For a tightly packed result, use `region.width * bytes_per_pixel`
+/// and `region.width * region.height * bytes_per_pixel`.
+/// Regions are processed on the calling thread, so only the kernels from [SwizzleOptions::context] are used.
+///
+/// Throws if the region is outside the mipmap, `source` has fewer bytes than [swizzled_mip_size],
+/// or `destination` is too small for the region with the given pitches.
+void deswizzle_block_linear_region(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    std::span<std::byte> destination,
+    size_t row_pitch,
+    size_t slice_pitch,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Swizzles the linear blocks in `source` into `region` of the existing swizzled mipmap `destination`.
+/// The dimensions describe the entire mipmap like for [swizzle_block_linear].
+/// Bytes outside the region are left unchanged, including bytes in GOBs that only partially overlap the region.
+///
+/// Rows of the region are read `row_pitch` bytes apart and depth slices `slice_pitch` bytes apart.
+/// Regions are processed on the calling thread, so only the kernels from [SwizzleOptions::context] are used.
+///
+/// Throws if the region is outside the mipmap, `destination` has fewer bytes than [swizzled_mip_size],
+/// or `source` is too small for the region with the given pitches.
+void swizzle_block_linear_region(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    size_t row_pitch,
+    size_t slice_pitch,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    MipRegion region,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options = SwizzleOptions()
+);
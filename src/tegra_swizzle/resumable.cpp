@@ -0,0 +1,123 @@
+#include <tegra_swizzle/lib.h>
+
+ResumableSurfaceJob::ResumableSurfaceJob(
+    const SurfaceLayout& layout,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    const SwizzleOptions& options,
+    MakeWorkFn make_work
+)
+    : _layout(layout), _source(source), _source_size(source_size), _result(result), _options(options), _make_work(make_work) {
+}
+
+bool ResumableSurfaceJob::step(std::chrono::nanoseconds budget) {
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    // Avoid overflowing the time point for very large budgets.
+    const std::chrono::steady_clock::time_point deadline = budget >= std::chrono::steady_clock::time_point::max() - now
+        ? std::chrono::steady_clock::time_point::max()
+        : now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+    return run_until(deadline);
+}
+
+void ResumableSurfaceJob::finish() {
+    run_until(std::chrono::steady_clock::time_point::max());
+}
+
+bool ResumableSurfaceJob::run_until(std::chrono::steady_clock::time_point deadline) {
+    while (_mip_index < _layout.mips.size()) {
+        const MipLayout& mip = _layout.mips[_mip_index];
+        if (!_work) {
+            _work = _make_work(mip, _layout.bytes_per_pixel, _source, _source_size, _result, 0, _options);
+            split_tasks_into_gob_rows(*_work);
+        }
+
+        const MipWork& work = *_work;
+        while (_task_index < work.task_count) {
+            work.run(work, _task_index, _task_index + 1);
+            _task_index += 1;
+
+            if (_task_index < work.task_count && std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+        }
+
+        _completed_size += mip.deswizzled_size;
+        _mip_index += 1;
+        _task_index = 0;
+        _work.reset();
+
+        if (_mip_index < _layout.mips.size() && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+double ResumableSurfaceJob::progress() const {
+    if (_layout.deswizzled_size == 0) {
+        return done() ? 1.0 : 0.0;
+    }
+
+    double completed_size = static_cast<double>(_completed_size);
+    if (_work && _work->task_count > 0) {
+        const double mip_size = static_cast<double>(_layout.mips[_mip_index].deswizzled_size);
+        completed_size += mip_size * _task_index / _work->task_count;
+    }
+    return completed_size / _layout.deswizzled_size;
+}
+
+template <bool DESWIZZLE>
+ResumableSurfaceJob start_resumable_job(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    const size_t surface_size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+    const size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+
+    const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, expected_size, source.size());
+    if (source_error) {
+        throw_runtime_error(swizzle_error_message(source_error->error));
+    }
+
+    const std::optional<SwizzleErrorInfo> result_error = check_size(SwizzleError::DestinationTooSmall, surface_size, result.size());
+    if (result_error) {
+        throw_runtime_error(swizzle_error_message(result_error->error));
+    }
+
+    unsigned char* _result = reinterpret_cast<unsigned char*>(result.data());
+    if (!DESWIZZLE) {
+        zero_layer_padding(layout, _result);
+    }
+
+    return ResumableSurfaceJob(
+        layout,
+        reinterpret_cast<const unsigned char*>(source.data()),
+        source.size(),
+        _result,
+        options,
+        &surface_mip_work<DESWIZZLE>
+    );
+}
+
+ResumableSurfaceJob swizzle_surface_resumable(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    return start_resumable_job<false>(layout, source, result, options);
+}
+
+ResumableSurfaceJob deswizzle_surface_resumable(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    return start_resumable_job<true>(layout, source, result, options);
+}
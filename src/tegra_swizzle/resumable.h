@@ -0,0 +1,114 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/surface.h>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <span>
+
+//! Functions for swizzling or deswizzling a surface in small steps on the calling thread.
+//!
+//! A frame can usually only spare a fraction of a millisecond for texture conversion.
+//! A [ResumableSurfaceJob] remembers its position in the layers, mipmaps, depth slices, and rows of GOBs,
+//! so a large surface can be converted over several frames by calling [ResumableSurfaceJob::step] once per frame.
+
+/// A surface being swizzled or deswizzled one row of GOBs at a time.
+/// Create a job with [swizzle_surface_resumable] or [deswizzle_surface_resumable].
+///
+/// The job runs on the thread calling [step] and never starts any threads.
+/// The result is identical to [swizzle_surface] or [deswizzle_surface] once [done] returns `true`.
+/// The source and result must outlive the job.
+class ResumableSurfaceJob {
+public:
+    /// Processes rows of GOBs until `budget` has passed or the surface is finished.
+    /// At least one row of GOBs is processed, so every call makes progress.
+    /// Each row of GOBs is 8 rows of blocks, so steps overshoot the budget by at most one row.
+    ///
+    /// Returns `true` if the surface is finished.
+    bool step(std::chrono::nanoseconds budget);
+
+    /// Processes every remaining row of GOBs.
+    void finish();
+
+    /// Returns `true` if every mipmap of the surface has been written.
+    bool done() const { return _mip_index == _layout.mips.size(); }
+
+    /// The fraction of the deswizzled bytes of the surface that have been processed from 0.0 to 1.0.
+    double progress() const;
+
+    /// The layout of the surface.
+    const SurfaceLayout& layout() const { return _layout; }
+
+private:
+    using MakeWorkFn = MipWork (*)(
+        const MipLayout& mip,
+        size_t bytes_per_pixel,
+        const unsigned char* source,
+        size_t source_size,
+        unsigned char* result,
+        size_t result_offset,
+        const SwizzleOptions& options
+    );
+
+    ResumableSurfaceJob(
+        const SurfaceLayout& layout,
+        const unsigned char* source,
+        size_t source_size,
+        unsigned char* result,
+        const SwizzleOptions& options,
+        MakeWorkFn make_work
+    );
+
+    template <bool DESWIZZLE>
+    friend ResumableSurfaceJob start_resumable_job(
+        const SurfaceLayout& layout,
+        std::span<const std::byte> source,
+        std::span<std::byte> result,
+        const SwizzleOptions& options
+    );
+
+    bool run_until(std::chrono::steady_clock::time_point deadline);
+
+    SurfaceLayout _layout;
+    const unsigned char* _source;
+    size_t _source_size;
+    unsigned char* _result;
+    SwizzleOptions _options;
+    MakeWorkFn _make_work;
+
+    // The position in the loop over mipmaps and the tasks of each mipmap.
+    // Each task is a row of GOBs in one or more depth slices.
+    size_t _mip_index = 0;
+    size_t _task_index = 0;
+    std::optional<MipWork> _work;
+    size_t _completed_size = 0;
+};
+
+/// Creates a job for swizzling all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without doing any work yet.
+/// The thread settings from `options` are ignored.
+///
+/// `source` and `result` must outlive the returned job.
+/// Throws if `source` has fewer bytes than `layout.deswizzled_size`
+/// or `result` has fewer bytes than `layout.swizzled_size`.
+ResumableSurfaceJob swizzle_surface_resumable(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Creates a job for deswizzling all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without doing any work yet.
+/// The thread settings from `options` are ignored.
+///
+/// `source` and `result` must outlive the returned job.
+/// Throws if `source` has fewer bytes than `layout.swizzled_size`
+/// or `result` has fewer bytes than `layout.deswizzled_size`.
+ResumableSurfaceJob deswizzle_surface_resumable(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
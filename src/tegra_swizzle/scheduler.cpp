@@ -0,0 +1,271 @@
+#include <tegra_swizzle/lib.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+
+// A range of tasks from a single large mipmap or a group of consecutive small mipmaps.
+// Groups are a single unit that is never split.
+struct ScheduledJob {
+    const MipWork* mips;
+    size_t mip_count;
+    bool split;
+    size_t unit_count;
+    size_t grain;
+};
+
+// The units `start..end` of the job at index `job`.
+struct ScheduledRange {
+    size_t job;
+    size_t start;
+    size_t end;
+};
+
+// The progress of faulting in the output pages for SwizzleOptions::first_touch.
+enum class TouchState {
+    Untouched,
+    Touching,
+    Touched
+};
+
+// A deque of ranges owned by a single thread.
+// The owner uses the back, and other threads steal from the front.
+// Align to a cache line, so threads do not contend for the locks of neighboring deques.
+// The ranges are only stolen once the pages of the initially dealt ranges are touched.
+struct alignas(64) WorkStealingDeque {
+    std::mutex mutex;
+    std::deque<ScheduledRange> ranges;
+    std::atomic<TouchState> touch_state{ TouchState::Touched };
+
+    void push_back(ScheduledRange range) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ranges.push_back(range);
+    }
+
+    bool pop_back(ScheduledRange& range) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ranges.empty()) {
+            return false;
+        }
+        range = ranges.back();
+        ranges.pop_back();
+        return true;
+    }
+
+    bool steal_front(ScheduledRange& range) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ranges.empty()) {
+            return false;
+        }
+        range = ranges.front();
+        ranges.pop_front();
+        return true;
+    }
+};
+
+static void run_range(const ScheduledJob& job, size_t start, size_t end) {
+    if (job.split) {
+        job.mips[0].run(job.mips[0], start, end);
+    }
+    else {
+        for (size_t i = 0; i < job.mip_count; ++i) {
+            job.mips[i].run(job.mips[i], 0, job.mips[i].task_count);
+        }
+    }
+}
+
+static void touch_range(const ScheduledJob& job, size_t start, size_t end) {
+    if (job.split) {
+        touch_tasks(job.mips[0], start, end);
+    }
+    else {
+        for (size_t i = 0; i < job.mip_count; ++i) {
+            touch_tasks(job.mips[i], 0, job.mips[i].task_count);
+        }
+    }
+}
+
+bool run_mip_work(std::span<const MipWork> mips, const SwizzleOptions& options) {
+    StopCheck stop(options);
+
+    size_t total_size = 0;
+    for (const MipWork& mip : mips) {
+        total_size += mip.size_in_bytes;
+    }
+
+    const bool parallel = total_size >= options.parallel_threshold_in_bytes;
+    const size_t thread_count = parallel ? resolved_thread_count(options) : 1;
+    if (thread_count <= 1) {
+        for (const MipWork& mip : mips) {
+            if (!stop.enabled()) {
+                mip.run(mip, 0, mip.task_count);
+                continue;
+            }
+
+            for (size_t task = 0; task < mip.task_count; ++task) {
+                if (stop.stopped()) {
+                    return false;
+                }
+                mip.run(mip, task, task + 1);
+            }
+        }
+        return true;
+    }
+
+    // Split large mipmaps into tasks and merge consecutive small mipmaps into groups.
+    std::pmr::vector<ScheduledJob> jobs(scratch_resource(options));
+    size_t group_start = 0;
+    size_t group_size = 0;
+    auto end_group = [&](size_t group_end) {
+        if (group_end > group_start) {
+            jobs.push_back(ScheduledJob{ mips.data() + group_start, group_end - group_start, false, 1, 1 });
+        }
+        group_start = group_end;
+        group_size = 0;
+    };
+
+    for (size_t i = 0; i < mips.size(); ++i) {
+        const MipWork& mip = mips[i];
+        if (mip.task_count > 1 && mip.size_in_bytes >= 2 * SCHEDULER_GRAIN_SIZE_IN_BYTES) {
+            end_group(i);
+            group_start = i + 1;
+
+            const size_t task_size = div_round_up(mip.size_in_bytes, mip.task_count);
+            const size_t grain = std::max(SCHEDULER_GRAIN_SIZE_IN_BYTES / task_size, (size_t)1);
+            jobs.push_back(ScheduledJob{ &mip, 1, true, mip.task_count, grain });
+        }
+        else {
+            group_size += mip.size_in_bytes;
+            if (group_size >= SCHEDULER_GRAIN_SIZE_IN_BYTES) {
+                end_group(i + 1);
+            }
+        }
+    }
+    end_group(mips.size());
+
+    // Deal the jobs to the threads and let stealing balance any differences.
+    // Large jobs are dealt as a contiguous range for each thread, so every thread starts on its own part of the output.
+    std::pmr::vector<WorkStealingDeque> deques(thread_count, scratch_resource(options));
+    std::atomic<size_t> remaining_units{ 0 };
+    size_t total_units = 0;
+    size_t next_deque = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const ScheduledJob& job = jobs[i];
+        const size_t range_count = std::min(thread_count, div_round_up(job.unit_count, job.grain));
+        for (size_t j = 0; j < range_count; ++j) {
+            const size_t start = job.unit_count * j / range_count;
+            const size_t end = job.unit_count * (j + 1) / range_count;
+            deques[next_deque].ranges.push_back(ScheduledRange{ i, start, end });
+            next_deque = (next_deque + 1) % thread_count;
+        }
+        total_units += job.unit_count;
+    }
+    remaining_units.store(total_units);
+
+    // Idle workers sleep until another thread makes more ranges available or finishes the last range.
+    // Each change increments the generation, so a worker never misses a change made after it looked for ranges.
+    std::mutex idle_mutex;
+    std::condition_variable idle;
+    size_t generation = 0;
+    auto wake_idle = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex);
+            generation++;
+        }
+        idle.notify_all();
+    };
+
+    // Fault in the output pages of the dealt ranges on the thread that owns them.
+    // Other threads only steal ranges from a deque once its pages are touched,
+    // so touching never overwrites finished output.
+    if (options.first_touch) {
+        for (WorkStealingDeque& deque : deques) {
+            deque.touch_state.store(TouchState::Untouched);
+        }
+    }
+
+    // Returns `false` if another thread is already touching the pages of `deque`.
+    auto touch = [&](WorkStealingDeque& deque) {
+        TouchState state = TouchState::Untouched;
+        if (!deque.touch_state.compare_exchange_strong(state, TouchState::Touching)) {
+            return state == TouchState::Touched;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(deque.mutex);
+            for (const ScheduledRange& range : deque.ranges) {
+                touch_range(jobs[range.job], range.start, range.end);
+            }
+        }
+        deque.touch_state.store(TouchState::Touched, std::memory_order_release);
+        wake_idle();
+        return true;
+    };
+
+    auto worker = [&](size_t thread_index) {
+        WorkStealingDeque& own = deques[thread_index];
+        touch(own);
+
+        ScheduledRange range;
+        while (true) {
+            size_t seen_generation;
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                seen_generation = generation;
+            }
+
+            bool found = own.pop_back(range);
+            for (size_t i = 1; !found && i < thread_count; ++i) {
+                WorkStealingDeque& other = deques[(thread_index + i) % thread_count];
+                if (other.touch_state.load(std::memory_order_acquire) == TouchState::Touched) {
+                    found = other.steal_front(range);
+                }
+            }
+
+            // Touch the ranges of threads that have not started yet instead of waiting for them,
+            // since executors may run the workers one after another.
+            for (size_t i = 1; options.first_touch && !found && i < thread_count; ++i) {
+                WorkStealingDeque& other = deques[(thread_index + i) % thread_count];
+                if (touch(other)) {
+                    found = other.steal_front(range);
+                }
+            }
+
+            // The remaining ranges are already running on other threads.
+            // Those threads only push ranges or finish, so wait for either instead of spinning.
+            if (!found) {
+                if (remaining_units.load() == 0) {
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                idle.wait(lock, [&]() { return generation != seen_generation; });
+                continue;
+            }
+
+            // Keep the lower half and leave the upper half for this thread or thieves.
+            const ScheduledJob& job = jobs[range.job];
+            const bool split = range.end - range.start > job.grain;
+            while (range.end - range.start > job.grain) {
+                const size_t middle = range.start + (range.end - range.start) / 2;
+                own.push_back(ScheduledRange{ range.job, middle, range.end });
+                range.end = middle;
+            }
+            if (split) {
+                wake_idle();
+            }
+
+            // Stopped ranges still count as done, so the workers finish without running them.
+            if (!stop.stopped()) {
+                run_range(job, range.start, range.end);
+            }
+            if (remaining_units.fetch_sub(range.end - range.start) == range.end - range.start) {
+                wake_idle();
+            }
+        }
+    };
+
+    // Each index is a worker with its own deque.
+    // Workers started after the work is done return immediately.
+    parallel_for(thread_count, thread_count, options, worker);
+    return !stop.was_stopped();
+}
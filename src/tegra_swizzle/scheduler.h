@@ -0,0 +1,62 @@
+#pragma once
+
+#include <tegra_swizzle/lib.h>
+#include <tegra_swizzle/swizzle.h>
+#include <atomic>
+#include <chrono>
+#include <span>
+#include <cstddef>
+
+// A work stealing scheduler for the tasks of one or more mipmaps.
+//
+// Surfaces and batches mix tiny mipmaps with mipmaps much larger than the cache.
+// Each thread owns a deque of task ranges and takes ranges from the back of its own deque.
+// Ranges larger than the grain size are split in half, and the upper half is pushed back for other threads.
+// Idle threads steal from the front of the other deques, which holds the largest remaining ranges.
+// Large mipmaps are split recursively down to a few rows of blocks,
+// while consecutive small mipmaps are merged into groups that run inline on a single thread.
+
+// Checks the stop token and deadline from the options of a single call.
+// A stop is remembered, so every thread skips the remaining work once any thread sees it.
+class StopCheck {
+public:
+    explicit StopCheck(const SwizzleOptions& options)
+        : _stop_token(options.stop_token), _deadline(options.deadline) {
+        _enabled = _stop_token.stop_possible() || _deadline != std::chrono::steady_clock::time_point::max();
+    }
+
+    bool enabled() const { return _enabled; }
+
+    bool stopped() {
+        if (!_enabled) {
+            return false;
+        }
+        if (_stopped.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (_stop_token.stop_requested() || std::chrono::steady_clock::now() >= _deadline) {
+            _stopped.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    bool was_stopped() const { return _stopped.load(); }
+
+private:
+    std::stop_token _stop_token;
+    std::chrono::steady_clock::time_point _deadline;
+    bool _enabled;
+    std::atomic<bool> _stopped{ false };
+};
+
+/// Mipmaps are split into ranges of tasks or merged into groups of mipmaps with roughly this many deswizzled bytes.
+/// Smaller ranges balance the work better but cost more to schedule.
+const size_t SCHEDULER_GRAIN_SIZE_IN_BYTES = 64 << 10;
+
+/// Runs all the tasks of `mips` using the threads, context, or executor from `options`.
+/// The mipmaps run on the calling thread if they have fewer than
+/// [SwizzleOptions::parallel_threshold_in_bytes] deswizzled bytes in total.
+///
+/// Returns `false` if the stop token or deadline from `options` stopped the work before every task ran.
+bool run_mip_work(std::span<const MipWork> mips, const SwizzleOptions& options);
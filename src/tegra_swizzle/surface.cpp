@@ -0,0 +1,723 @@
+#include <tegra_swizzle/lib.h>
+
+// Infers the block height for the first mipmap if not specified.
+static BlockHeight surface_block_height_mip0(
+    size_t height,
+    size_t depth,
+    BlockDim block_dim,
+    std::optional<BlockHeight> _block_height_mip0
+) {
+    // TODO: Enforce a block height of 1 for depth textures elsewhere?
+    return (depth == 1) ? _block_height_mip0.value_or(block_height_mip0(div_round_up(height, block_dim.height))) : BlockHeight::One;
+}
+
+// Calculates the dimensions and sizes of a single mipmap without its layer or offsets.
+// This is shared by the layout and surface size calculations.
+static MipLayout surface_mip_layout(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockDim block_dim,
+    BlockHeight block_height_mip0,
+    size_t block_depth_mip0,
+    size_t bytes_per_pixel,
+    size_t mip
+) {
+    MipLayout mip_layout{};
+    mip_layout.mip = mip;
+    mip_layout.width = std::max(div_round_up(width >> mip, block_dim.width), (size_t)1);
+    mip_layout.height = std::max(div_round_up(height >> mip, block_dim.height), (size_t)1);
+    mip_layout.depth = std::max(div_round_up(depth >> mip, block_dim.depth), (size_t)1);
+    mip_layout.block_height = mip_block_height(mip_layout.height, block_height_mip0);
+    mip_layout.block_depth = mip_block_depth(mip_layout.depth, block_depth_mip0);
+    mip_layout.swizzled_size = swizzled_mip_size(
+        mip_layout.width,
+        mip_layout.height,
+        mip_layout.depth,
+        mip_layout.block_height,
+        bytes_per_pixel
+    );
+    mip_layout.deswizzled_size = deswizzled_mip_size(
+        mip_layout.width,
+        mip_layout.height,
+        mip_layout.depth,
+        bytes_per_pixel
+    );
+    return mip_layout;
+}
+
+SurfaceLayout surface_layout(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockDim block_dim,
+    std::optional<BlockHeight> _block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count
+) {
+    const BlockHeight __block_height_mip0 = surface_block_height_mip0(height, depth, block_dim, _block_height_mip0);
+
+    // TODO: Don't assume block_depth is 1?
+    const size_t block_depth_mip0 = block_depth(depth);
+
+    SurfaceLayout layout;
+    layout.width = width;
+    layout.height = height;
+    layout.depth = depth;
+    layout.block_dim = block_dim;
+    layout.block_height_mip0 = __block_height_mip0;
+    layout.bytes_per_pixel = bytes_per_pixel;
+    layout.mipmap_count = mipmap_count;
+    layout.layer_count = layer_count;
+    layout.mips.reserve(layer_count * mipmap_count);
+
+    size_t swizzled_offset = 0;
+    size_t deswizzled_offset = 0;
+    for (size_t layer = 0; layer < layer_count; ++layer) {
+        for (size_t mip = 0; mip < mipmap_count; ++mip) {
+            MipLayout mip_layout = surface_mip_layout(
+                width,
+                height,
+                depth,
+                block_dim,
+                __block_height_mip0,
+                block_depth_mip0,
+                bytes_per_pixel,
+                mip
+            );
+            mip_layout.layer = layer;
+            mip_layout.swizzled_offset = swizzled_offset;
+            mip_layout.deswizzled_offset = deswizzled_offset;
+
+            swizzled_offset += mip_layout.swizzled_size;
+            deswizzled_offset += mip_layout.deswizzled_size;
+            layout.mips.push_back(mip_layout);
+        }
+
+        // We only need alignment between layers.
+        if (layer_count > 1) {
+            swizzled_offset = align_layer_size(swizzled_offset, height, depth, __block_height_mip0, 1);
+        }
+    }
+
+    layout.swizzled_size = swizzled_offset;
+    layout.deswizzled_size = deswizzled_offset;
+    return layout;
+}
+
+size_t swizzled_surface_size(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockDim block_dim, // TODO: Use None to indicate uncompressed?
+    std::optional<BlockHeight> _block_height_mip0, // TODO: Make this optional in other functions as well?
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count
+) {
+    const BlockHeight __block_height_mip0 = surface_block_height_mip0(height, depth, block_dim, _block_height_mip0);
+    const size_t block_depth_mip0 = block_depth(depth);
+
+    size_t layer_size = 0;
+    for (size_t mip = 0; mip < mipmap_count; ++mip) {
+        layer_size += surface_mip_layout(
+            width,
+            height,
+            depth,
+            block_dim,
+            __block_height_mip0,
+            block_depth_mip0,
+            bytes_per_pixel,
+            mip
+        ).swizzled_size;
+    }
+
+    // We only need alignment between layers.
+    if (layer_count > 1) {
+        layer_size = align_layer_size(layer_size, height, depth, __block_height_mip0, 1);
+    }
+
+    return layer_size * layer_count;
+}
+
+size_t deswizzled_surface_size(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockDim block_dim,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count
+) {
+    // The block height does not affect the deswizzled size.
+    const BlockHeight __block_height_mip0 = surface_block_height_mip0(height, depth, block_dim, std::nullopt);
+    const size_t block_depth_mip0 = block_depth(depth);
+
+    size_t layer_size = 0;
+    for (size_t mip = 0; mip < mipmap_count; ++mip) {
+        layer_size += surface_mip_layout(
+            width,
+            height,
+            depth,
+            block_dim,
+            __block_height_mip0,
+            block_depth_mip0,
+            bytes_per_pixel,
+            mip
+        ).deswizzled_size;
+    }
+
+    return layer_size * layer_count;
+}
+
+// Returns the size of the output surface after checking that the source is large enough.
+template <bool DESWIZZLE>
+size_t surface_destination_size(const SurfaceLayout& layout, size_t source_size) {
+    size_t surface_size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+    size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+
+    // Validate the source length before attempting to allocate.
+    // This reduces potential out of memory panics.
+    if (source_size < expected_size) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    return surface_size;
+}
+
+template <bool DESWIZZLE>
+void surface_destination(
+    const SurfaceLayout& layout,
+    size_t source_size,
+    unsigned char** result,
+    size_t* result_size
+) {
+    const size_t surface_size = surface_destination_size<DESWIZZLE>(layout, source_size);
+
+    // Assume the calculated size is accurate, so don't reallocate later.
+    // The swizzle functions write every byte including padding, so skip zero initialization.
+    *result = new unsigned char[surface_size];
+    *result_size = surface_size;
+}
+
+void zero_layer_padding(const SurfaceLayout& layout, unsigned char* result) {
+    for (size_t i = 0; i < layout.mips.size(); ++i) {
+        const MipLayout& mip = layout.mips[i];
+        if (mip.mip + 1 == layout.mipmap_count) {
+            const size_t mip_end = mip.swizzled_offset + mip.swizzled_size;
+            const size_t next_offset = (i + 1 < layout.mips.size()) ? layout.mips[i + 1].swizzled_offset : layout.swizzled_size;
+            const size_t layer_end = std::min(next_offset, layout.swizzled_size);
+            // Hand built layouts may have mipmaps that end past the next layer or the surface.
+            if (mip_end < layer_end) {
+                std::fill(result + mip_end, result + layer_end, (unsigned char)0);
+            }
+        }
+    }
+}
+
+template <bool DESWIZZLE>
+MipWork surface_mip_work(
+    const MipLayout& mip,
+    size_t bytes_per_pixel,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    size_t result_offset,
+    const SwizzleOptions& options
+) {
+    const size_t src_offset = DESWIZZLE ? mip.swizzled_offset : mip.deswizzled_offset;
+    const size_t dst_offset = (DESWIZZLE ? mip.deswizzled_offset : mip.swizzled_offset) - result_offset;
+
+    return mip_work<DESWIZZLE>(
+        mip.width,
+        mip.height,
+        mip.depth,
+        source + src_offset,
+        source_size - src_offset,
+        result + dst_offset,
+        DESWIZZLE ? mip.deswizzled_size : mip.swizzled_size,
+        mip.block_height,
+        mip.block_depth,
+        bytes_per_pixel,
+        options
+    );
+}
+
+template MipWork surface_mip_work<false>(
+    const MipLayout& mip,
+    size_t bytes_per_pixel,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    size_t result_offset,
+    const SwizzleOptions& options
+);
+
+template MipWork surface_mip_work<true>(
+    const MipLayout& mip,
+    size_t bytes_per_pixel,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    size_t result_offset,
+    const SwizzleOptions& options
+);
+
+// Swizzle or deswizzle the given mipmaps of a surface.
+// Destination offsets are relative to `result_offset`, so a subset of the mipmaps can be written to a smaller buffer.
+// Returns an error if a mipmap extends past `source_size` or `result_size`
+// or if the stop token or deadline from `options` stopped the work early.
+template <bool DESWIZZLE>
+std::optional<SwizzleErrorInfo> swizzle_mips(
+    std::span<const MipLayout> mips,
+    size_t bytes_per_pixel,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    size_t result_offset,
+    size_t result_size,
+    const SwizzleOptions& options
+) {
+    // Make sure the source and result have enough space before starting any work.
+    // Hand built layouts may have mipmaps outside the sizes checked by the callers.
+    for (const MipLayout& mip : mips) {
+        const size_t src_end = DESWIZZLE
+            ? mip.swizzled_offset + mip.swizzled_size
+            : mip.deswizzled_offset + mip.deswizzled_size;
+        const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, src_end, source_size);
+        if (source_error) {
+            return source_error;
+        }
+
+        const size_t dst_end = DESWIZZLE
+            ? mip.deswizzled_offset + mip.deswizzled_size
+            : mip.swizzled_offset + mip.swizzled_size;
+        const std::optional<SwizzleErrorInfo> result_error = check_size(SwizzleError::DestinationTooSmall, dst_end - result_offset, result_size);
+        if (result_error) {
+            return result_error;
+        }
+    }
+
+    // Schedule the tasks of every mipmap together, so small and large mipmaps are balanced across threads.
+    std::pmr::vector<MipWork> work(scratch_resource(options));
+    work.reserve(mips.size());
+    for (const MipLayout& mip : mips) {
+        work.push_back(surface_mip_work<DESWIZZLE>(mip, bytes_per_pixel, source, source_size, result, result_offset, options));
+    }
+
+    if (!run_mip_work(work, options)) {
+        return SwizzleErrorInfo{ SwizzleError::Cancelled, 0, 0 };
+    }
+    return std::nullopt;
+}
+
+// Swizzle or deswizzle every mipmap of a surface.
+// Callers check that `result` has at least the swizzled or deswizzled size of `layout`.
+template <bool DESWIZZLE>
+std::optional<SwizzleErrorInfo> swizzle_surface_inner(
+    const SurfaceLayout& layout,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    const SwizzleOptions& options
+) {
+    if (!DESWIZZLE) {
+        zero_layer_padding(layout, result);
+    }
+
+    const size_t surface_size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+    return swizzle_mips<DESWIZZLE>(layout.mips, layout.bytes_per_pixel, source, source_size, result, 0, surface_size, options);
+}
+
+// Shared implementation for the surface functions that write to caller provided memory.
+template <bool DESWIZZLE>
+SwizzleExpected<size_t> try_surface_span(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<size_t> {
+        const size_t surface_size = DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size;
+        const size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+
+        const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, expected_size, source.size());
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        const std::optional<SwizzleErrorInfo> result_error = check_size(SwizzleError::DestinationTooSmall, surface_size, result.size());
+        if (result_error) {
+            return SwizzleUnexpected(*result_error);
+        }
+
+        const std::optional<SwizzleErrorInfo> error = swizzle_surface_inner<DESWIZZLE>(
+            layout,
+            reinterpret_cast<const unsigned char*>(source.data()),
+            source.size(),
+            reinterpret_cast<unsigned char*>(result.data()),
+            options
+        );
+        if (error) {
+            return SwizzleUnexpected(*error);
+        }
+
+        return surface_size;
+    });
+}
+
+template <bool DESWIZZLE>
+void surface_span(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    const SwizzleExpected<size_t> written = try_surface_span<DESWIZZLE>(layout, source, result, options);
+    if (!written) {
+        throw_runtime_error(swizzle_error_message(written.error().error));
+    }
+}
+
+// Shared implementation for the surface functions that allocate from a memory resource.
+template <bool DESWIZZLE>
+SwizzleExpected<SwizzleBuffer> try_surface_buffer(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<SwizzleBuffer> {
+        // Validate the source length before attempting to allocate.
+        const size_t expected_size = DESWIZZLE ? layout.swizzled_size : layout.deswizzled_size;
+        const std::optional<SwizzleErrorInfo> source_error = check_size(SwizzleError::NotEnoughData, expected_size, source.size());
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        SwizzleBuffer result = output_buffer(DESWIZZLE ? layout.deswizzled_size : layout.swizzled_size, resource, options);
+        const SwizzleExpected<size_t> written = try_surface_span<DESWIZZLE>(layout, source, result.span(), options);
+        if (!written) {
+            return SwizzleUnexpected(written.error());
+        }
+        return result;
+    });
+}
+
+template <bool DESWIZZLE>
+SwizzleBuffer surface_buffer(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    SwizzleExpected<SwizzleBuffer> result = try_surface_buffer<DESWIZZLE>(layout, source, resource, options);
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+    return std::move(*result);
+}
+
+void swizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    BlockDim block_dim, // TODO: Use None to indicate uncompressed?
+    std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    unsigned char** result,
+    size_t* result_size,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    surface_destination<false>(layout, source_size, result, result_size);
+
+    const std::optional<SwizzleErrorInfo> error = swizzle_surface_inner<false>(layout, source, source_size, *result, options);
+    if (error) {
+        delete[] *result;
+        *result = nullptr;
+        *result_size = 0;
+        throw_runtime_error(swizzle_error_message(error->error));
+    }
+}
+
+void swizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    surface_span<false>(layout, source, result, options);
+}
+
+void swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    surface_span<false>(layout, source, result, options);
+}
+
+SwizzleBuffer swizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    return surface_buffer<false>(layout, source, resource, options);
+}
+
+SwizzleBuffer swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    return surface_buffer<false>(layout, source, resource, options);
+}
+
+SwizzleExpected<size_t> try_swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) noexcept {
+    return try_surface_span<false>(layout, source, result, options);
+}
+
+SwizzleExpected<SwizzleBuffer> try_swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return try_surface_buffer<false>(layout, source, resource, options);
+}
+
+void deswizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    unsigned char** result,
+    size_t* result_size,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    surface_destination<true>(layout, source_size, result, result_size);
+
+    const std::optional<SwizzleErrorInfo> error = swizzle_surface_inner<true>(layout, source, source_size, *result, options);
+    if (error) {
+        delete[] *result;
+        *result = nullptr;
+        *result_size = 0;
+        throw_runtime_error(swizzle_error_message(error->error));
+    }
+}
+
+void deswizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    surface_span<true>(layout, source, result, options);
+}
+
+void deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    surface_span<true>(layout, source, result, options);
+}
+
+SwizzleBuffer deswizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    const SurfaceLayout layout = surface_layout(
+        width,
+        height,
+        depth,
+        block_dim,
+        block_height_mip0,
+        bytes_per_pixel,
+        mipmap_count,
+        layer_count
+    );
+
+    return surface_buffer<true>(layout, source, resource, options);
+}
+
+SwizzleBuffer deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    return surface_buffer<true>(layout, source, resource, options);
+}
+
+SwizzleExpected<size_t> try_deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) noexcept {
+    return try_surface_span<true>(layout, source, result, options);
+}
+
+SwizzleExpected<SwizzleBuffer> try_deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return try_surface_buffer<true>(layout, source, resource, options);
+}
+
+std::span<const MipLayout> layer_mips(const SurfaceLayout& layout, size_t layer, size_t mip_start, size_t mip_count) {
+    if (layer >= layout.layer_count || mip_start + mip_count > layout.mipmap_count) {
+        throw_runtime_error("Mipmap range is outside the surface!");
+    }
+
+    return std::span<const MipLayout>(layout.mips).subspan(layer * layout.mipmap_count + mip_start, mip_count);
+}
+
+size_t deswizzled_mips_size(const SurfaceLayout& layout, size_t layer, size_t mip_start, size_t mip_count) {
+    size_t size = 0;
+    for (const MipLayout& mip : layer_mips(layout, layer, mip_start, mip_count)) {
+        size += mip.deswizzled_size;
+    }
+    return size;
+}
+
+void deswizzle_surface_mips(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    size_t layer,
+    size_t mip_start,
+    size_t mip_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options
+) {
+    const std::span<const MipLayout> mips = layer_mips(layout, layer, mip_start, mip_count);
+    if (mips.empty()) {
+        return;
+    }
+
+    if (result.size() < deswizzled_mips_size(layout, layer, mip_start, mip_count)) {
+        throw_runtime_error("Destination is too small!");
+    }
+
+    const std::optional<SwizzleErrorInfo> error = swizzle_mips<true>(
+        mips,
+        layout.bytes_per_pixel,
+        reinterpret_cast<const unsigned char*>(source.data()),
+        source.size(),
+        reinterpret_cast<unsigned char*>(result.data()),
+        mips.front().deswizzled_offset,
+        result.size(),
+        options
+    );
+    if (error) {
+        throw_runtime_error(swizzle_error_message(error->error));
+    }
+}
@@ -6,6 +6,8 @@
 #include <tegra_swizzle/arrays.h>
 #include <vector>
 #include <algorithm>
+#include <span>
+#include <cstddef>
 
 //! Functions for working with surfaces stored in a combined buffer for all array layers and mipmaps.
 //!
@@ -65,6 +67,65 @@ constexpr BlockDim block_dim_4x4() {
     return blockDim;
 }
 
+/// The dimensions and location of a single array layer and mipmap in a surface.
+/// Dimensions are in blocks rather than pixels.
+struct MipLayout {
+    size_t layer;
+    size_t mip;
+    size_t width;
+    size_t height;
+    size_t depth;
+    BlockHeight block_height;
+    size_t block_depth;
+    size_t swizzled_offset;
+    size_t swizzled_size;
+    size_t deswizzled_offset;
+    size_t deswizzled_size;
+};
+
+/// The precomputed offsets and sizes for all array layers and mipmaps in a surface.
+/// Create a layout with [surface_layout] and reuse it for any number of swizzle or deswizzle calls.
+struct SurfaceLayout {
+    size_t width;
+    size_t height;
+    size_t depth;
+    BlockDim block_dim;
+    BlockHeight block_height_mip0;
+    size_t bytes_per_pixel;
+    size_t mipmap_count;
+    size_t layer_count;
+
+    /// The layout for each array layer and mipmap ordered by layer and then mipmap.
+    std::vector<MipLayout> mips;
+
+    /// The size in bytes of the swizzled surface including padding and alignment between layers.
+    size_t swizzled_size;
+    /// The size in bytes of the tightly packed deswizzled surface.
+    size_t deswizzled_size;
+
+    /// The layout for the given array layer and mipmap.
+    const MipLayout& mip(size_t layer, size_t mip) const {
+        return mips[layer * mipmap_count + mip];
+    }
+};
+
+/// Calculates the offsets and sizes for all the array layers and mipmaps of the given surface.
+/// The swizzled offsets include the alignment between array layers.
+///
+/// Dimensions should be in pixels.
+///
+/// Set `block_height_mip0` to [None] to infer the block height from the specified dimensions.
+SurfaceLayout surface_layout(
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockDim block_dim,
+    std::optional<BlockHeight> _block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count
+);
+
 // TODO: Add examples.
 /// Calculates the size in bytes for the swizzled data for the given surface.
 /// Compare with [deswizzled_surface_size].
@@ -77,44 +138,11 @@ size_t swizzled_surface_size(
     size_t height,
     size_t depth,
     BlockDim block_dim, // TODO: Use None to indicate uncompressed?
-    std::optional<BlockHeight> _block_height_mip0, // TODO: Make this optional in other functions as well?
+    std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
     size_t bytes_per_pixel,
     size_t mipmap_count,
     size_t layer_count
-) {
-    size_t block_width = block_dim.width;
-    size_t block_height = block_dim.height;
-    size_t block_depth = block_dim.depth;
-
-    // The block height can be inferred if not specified.
-    // TODO: Enforce a block height of 1 for depth textures elsewhere?
-    BlockHeight __block_height_mip0 = (depth == 1) ? _block_height_mip0.value_or(block_height_mip0(div_round_up(height, block_height))) : BlockHeight::One;
-
-    size_t mip_size = 0;
-    for (size_t mip = 0; mip < mipmap_count; ++mip) {
-        size_t mip_width = std::max(div_round_up(width >> mip, block_width), (size_t)1);
-        size_t mip_height = std::max(div_round_up(height >> mip, block_height), (size_t)1);
-        size_t mip_depth = std::max(div_round_up(depth >> mip, block_depth), (size_t)1);
-        BlockHeight _mip_block_height = mip_block_height(mip_height, __block_height_mip0);
-
-        mip_size += swizzled_mip_size(
-            mip_width,
-            mip_height,
-            mip_depth,
-            _mip_block_height,
-            bytes_per_pixel
-        );
-    }
-
-    if (layer_count > 1) {
-        // We only need alignment between layers.
-        size_t layer_size = align_layer_size(mip_size, height, depth, __block_height_mip0, 1);
-        return layer_size * layer_count;
-    }
-    else {
-        return mip_size;
-    }
-}
+);
 
 // TODO: Add examples.
 /// Calculates the size in bytes for the deswizzled data for the given surface.
@@ -129,291 +157,279 @@ size_t deswizzled_surface_size(
     size_t bytes_per_pixel,
     size_t mipmap_count,
     size_t layer_count
-) {
-    // TODO: Avoid duplicating this code.
-    const size_t block_width = block_dim.width;
-    const size_t block_height = block_dim.height;
-    const size_t block_depth = block_dim.depth;
-
-    size_t layer_size = 0;
-    for (size_t mip = 0; mip < mipmap_count; mip++) {
-        size_t mip_width = std::max(div_round_up(width >> mip, block_width), (size_t)1);
-        size_t mip_height = std::max(div_round_up(height >> mip, block_height), (size_t)1);
-        size_t mip_depth = std::max(div_round_up(depth >> mip, block_depth), (size_t)1);
-        layer_size += deswizzled_mip_size(mip_width, mip_height, mip_depth, bytes_per_pixel);
-    }
-
-    return layer_size * layer_count;
-}
+);
 
-template <bool DESWIZZLE>
-void surface_destination(
+/// Swizzles all the array layers and mipmaps in `source` using the block linear algorithm
+/// to a combined vector with appropriate mipmap and layer alignment.
+///
+/// Returns [SwizzleError::NotEnoughData] if `source` does not have
+/// at least as many bytes as the result of [deswizzled_surface_size].
+///
+/// Set `block_height_mip0` to [None] to infer the block height from the specified dimensions.
+void swizzle_surface(
     size_t width,
     size_t height,
     size_t depth,
-    BlockDim block_dim,
-    std::optional<BlockHeight> block_height_mip0,
+    const unsigned char* source,
+    size_t source_size,
+    BlockDim block_dim, // TODO: Use None to indicate uncompressed?
+    std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
     size_t bytes_per_pixel,
     size_t mipmap_count,
     size_t layer_count,
-    unsigned char* source,
-    size_t source_size,
     unsigned char** result,
-    size_t* result_size
-) {
-    size_t swizzled_size = swizzled_surface_size(
-        width,
-        height,
-        depth,
-        block_dim,
-        block_height_mip0,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count
-    );
-    size_t deswizzled_size = deswizzled_surface_size(
-        width,
-        height,
-        depth,
-        block_dim,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count
-    );
-
-    size_t surface_size = DESWIZZLE ? deswizzled_size : swizzled_size;
-    size_t expected_size = DESWIZZLE ? swizzled_size : deswizzled_size;
-
-    // Validate the source length before attempting to allocate.
-    // This reduces potential out of memory panics.
-    if (source_size < expected_size) {
-        throw std::runtime_error("Not enough data!");
-    }
+    size_t* result_size,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    // Assume the calculated size is accurate, so don't reallocate later.
-    *result = new unsigned char[surface_size];
-    std::fill(*result, *result + surface_size, (unsigned char)0);
-    *result_size = surface_size;
-}
-
-template <bool DESWIZZLE>
-void swizzle_mipmap(
+/// Swizzles all the array layers and mipmaps in `source` into the caller provided `result` without allocating.
+/// Only the first [swizzled_surface_size] bytes of `result` are written.
+///
+/// Throws if `source` has fewer bytes than [deswizzled_surface_size]
+/// or `result` has fewer bytes than [swizzled_surface_size].
+void swizzle_surface(
     size_t width,
     size_t height,
     size_t depth,
-    BlockHeight block_height,
-    size_t block_depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
     size_t bytes_per_pixel,
-    unsigned char* source,
-    size_t source_size,
-    size_t& src_offset,
-    unsigned char* dst,
-    size_t dst_size,
-    size_t& dst_offset
-) {
-    size_t swizzled_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
-    size_t deswizzled_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
-
-    // Make sure the source has enough space.
-    if (DESWIZZLE && source_size < src_offset + swizzled_size) {
-        throw std::runtime_error("Not enough data!");
-    }
-
-    if (!DESWIZZLE && source_size < src_offset + deswizzled_size) {
-        throw std::runtime_error("Not enough data!");
-    }
-
+    size_t mipmap_count,
+    size_t layer_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    // Swizzle the data and move to the next section.
-    swizzle_inner<DESWIZZLE>(
-        width,
-        height,
-        depth,
-        source + src_offset,
-        source_size - src_offset,
-        dst + dst_offset,
-        dst_size - dst_offset,
-        block_height,
-        block_depth,
-        bytes_per_pixel
-    );
-
-    if (DESWIZZLE) {
-        src_offset += swizzled_size;
-        dst_offset += deswizzled_size;
-    }
-    else {
-        src_offset += deswizzled_size;
-        dst_offset += swizzled_size;
-    }
-}
+/// Swizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without allocating.
+/// Only the first `layout.swizzled_size` bytes of `result` are written.
+///
+/// Throws if `source` has fewer bytes than `layout.deswizzled_size`
+/// or `result` has fewer bytes than `layout.swizzled_size`.
+void swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-template <bool DESWIZZLE>
-void swizzle_surface_inner(
+/// Swizzles all the array layers and mipmaps in `source` into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than [deswizzled_surface_size].
+/// The source is checked before allocating.
+SwizzleBuffer swizzle_surface(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
-    size_t source_size,
-    unsigned char* result,
-    size_t result_size,
+    std::span<const std::byte> source,
     BlockDim block_dim,
-    std::optional<BlockHeight> _block_height_mip0, // TODO: Make this optional in other functions as well?
+    std::optional<BlockHeight> block_height_mip0,
     size_t bytes_per_pixel,
     size_t mipmap_count,
-    size_t layer_count
-) {
-    size_t block_width = block_dim.width;
-    size_t block_height = block_dim.height;
-    size_t _block_depth = block_dim.depth;
-
-    // The block height can be inferred if not specified.
-    // TODO: Enforce a block height of 1 for depth textures elsewhere?
-    BlockHeight __block_height_mip0 = (depth == 1) ? _block_height_mip0.value_or(block_height_mip0(div_round_up(height, block_height))) : BlockHeight::One;
-
-    // TODO: Don't assume block_depth is 1?
-    const size_t block_depth_mip0 = block_depth(depth);
-
-    size_t src_offset = 0;
-    size_t dst_offset = 0;
-    for (size_t i = 0; i < layer_count; ++i) {
-        for (size_t mip = 0; mip < mipmap_count; ++mip) {
-            size_t mip_width = std::max(div_round_up(width >> mip, block_width), (size_t)1);
-            size_t mip_height = std::max(div_round_up(height >> mip, block_height), (size_t)1);
-            size_t mip_depth = std::max(div_round_up(depth >> mip, _block_depth), (size_t)1);
-
-            BlockHeight _mip_block_height = mip_block_height(mip_height, __block_height_mip0);
-            size_t _mip_block_depth = mip_block_depth(mip_depth, block_depth_mip0);
-
-            swizzle_mipmap<DESWIZZLE>(
-                mip_width,
-                mip_height,
-                mip_depth,
-                _mip_block_height,
-                _mip_block_depth,
-                bytes_per_pixel,
-                source,
-                source_size,
-                src_offset,
-                result,
-                result_size,
-                dst_offset
-            );
-        }
-
-        // Align offsets between array layers.
-        if (layer_count > 1) {
-            if (DESWIZZLE) {
-                src_offset = align_layer_size(src_offset, height, depth, __block_height_mip0, 1);
-            }
-            else {
-                dst_offset = align_layer_size(dst_offset, height, depth, __block_height_mip0, 1);
-            }
-        }
-    }
-}
+    size_t layer_count,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-/// Swizzles all the array layers and mipmaps in `source` using the block linear algorithm
-/// to a combined vector with appropriate mipmap and layer alignment.
+/// Swizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than `layout.deswizzled_size`.
+SwizzleBuffer swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Swizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without allocating or throwing.
+///
+/// Returns the number of bytes written.
+/// Fails with [SwizzleError::NotEnoughData] if `source` has fewer bytes than `layout.deswizzled_size`
+/// or [SwizzleError::DestinationTooSmall] if `result` has fewer bytes than `layout.swizzled_size`.
+/// A mipmap in a hand built `layout` that extends past these sizes fails the same way.
+/// Fails with [SwizzleError::Cancelled] if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work.
+/// Fails with [SwizzleError::OutOfResources] if memory for scheduling the work or threads cannot be allocated.
+SwizzleExpected<size_t> try_swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Swizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into a new [SwizzleBuffer] allocated from `resource` without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if `source` has fewer bytes than `layout.deswizzled_size`.
+/// The source is checked before allocating.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SwizzleBuffer> try_swizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+// TODO: Find a way to simplify the parameters.
+/// Deswizzles all the array layers and mipmaps in `source` using the block linear algorithm
+/// to a new vector without any padding between layers or mipmaps.
 ///
 /// Returns [SwizzleError::NotEnoughData] if `source` does not have
-/// at least as many bytes as the result of [deswizzled_surface_size].
+/// at least as many bytes as the result of [swizzled_surface_size].
 ///
 /// Set `block_height_mip0` to [None] to infer the block height from the specified dimensions.
-void swizzle_surface(
+void deswizzle_surface(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
+    const unsigned char* source,
     size_t source_size,
-    BlockDim block_dim, // TODO: Use None to indicate uncompressed?
+    BlockDim block_dim,
     std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
     size_t bytes_per_pixel,
     size_t mipmap_count,
     size_t layer_count,
     unsigned char** result,
-    size_t* result_size
-) {
-    surface_destination<false>(
-        width,
-        height,
-        depth,
-        block_dim,
-        block_height_mip0,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count,
-        source,
-        source_size,
-        result,
-        result_size
-    );
-
-    swizzle_surface_inner<false>(
-        width,
-        height,
-        depth,
-        source,
-        source_size,
-        *result,
-        *result_size,
-        block_dim,
-        block_height_mip0,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count
-    );
-}
+    size_t* result_size,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-// TODO: Find a way to simplify the parameters.
-/// Deswizzles all the array layers and mipmaps in `source` using the block linear algorithm
-/// to a new vector without any padding between layers or mipmaps.
+/// Deswizzles all the array layers and mipmaps in `source` into the caller provided `result` without allocating.
+/// Only the first [deswizzled_surface_size] bytes of `result` are written.
 ///
-/// Returns [SwizzleError::NotEnoughData] if `source` does not have
-/// at least as many bytes as the result of [swizzled_surface_size].
+/// Throws if `source` has fewer bytes than [swizzled_surface_size]
+/// or `result` has fewer bytes than [deswizzled_surface_size].
+void deswizzle_surface(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockDim block_dim,
+    std::optional<BlockHeight> block_height_mip0,
+    size_t bytes_per_pixel,
+    size_t mipmap_count,
+    size_t layer_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without allocating.
+/// Only the first `layout.deswizzled_size` bytes of `result` are written.
 ///
-/// Set `block_height_mip0` to [None] to infer the block height from the specified dimensions.
+/// Throws if `source` has fewer bytes than `layout.swizzled_size`
+/// or `result` has fewer bytes than `layout.deswizzled_size`.
 void deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps in `source` into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than [swizzled_surface_size].
+/// The source is checked before allocating.
+SwizzleBuffer deswizzle_surface(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
-    size_t source_size,
+    std::span<const std::byte> source,
     BlockDim block_dim,
-    std::optional<BlockHeight> block_height_mip0, // TODO: Make this optional in other functions as well?
+    std::optional<BlockHeight> block_height_mip0,
     size_t bytes_per_pixel,
     size_t mipmap_count,
     size_t layer_count,
-    unsigned char** result,
-    size_t* result_size
-) {
-    surface_destination<true>(
-        width,
-        height,
-        depth,
-        block_dim,
-        block_height_mip0,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count,
-        source,
-        source_size,
-        result,
-        result_size
-    );
-
-    swizzle_surface_inner<true>(
-        width,
-        height,
-        depth,
-        source,
-        source_size,
-        *result,
-        *result_size,
-        block_dim,
-        block_height_mip0,
-        bytes_per_pixel,
-        mipmap_count,
-        layer_count
-    );
-}
\ No newline at end of file
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than `layout.swizzled_size`.
+SwizzleBuffer deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
+
+/// Deswizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into the caller provided `result` without allocating or throwing.
+///
+/// Returns the number of bytes written.
+/// Fails with [SwizzleError::NotEnoughData] if `source` has fewer bytes than `layout.swizzled_size`
+/// or [SwizzleError::DestinationTooSmall] if `result` has fewer bytes than `layout.deswizzled_size`.
+/// A mipmap in a hand built `layout` that extends past these sizes fails the same way.
+/// Fails with [SwizzleError::Cancelled] if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work.
+/// Fails with [SwizzleError::OutOfResources] if memory for scheduling the work or threads cannot be allocated.
+SwizzleExpected<size_t> try_deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Deswizzles all the array layers and mipmaps in `source` for a precomputed `layout`
+/// into a new [SwizzleBuffer] allocated from `resource` without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if `source` has fewer bytes than `layout.swizzled_size`.
+/// The source is checked before allocating.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SwizzleBuffer> try_deswizzle_surface(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Zeroes the alignment padding after the last mipmap of each array layer in the swizzled surface `result`.
+/// `result` must have at least `layout.swizzled_size` bytes.
+/// The swizzle functions already write this padding.
+void zero_layer_padding(const SurfaceLayout& layout, unsigned char* result);
+
+// Prepares the work for a single mipmap of a surface.
+// `source` and `result` point to the start of the surface data, and `source_size` is the size of the entire source.
+// The mipmap is written `result_offset` bytes earlier in `result` than its offset in the layout.
+// Both directions are explicitly instantiated in surface.cpp.
+template <bool DESWIZZLE>
+MipWork surface_mip_work(
+    const MipLayout& mip,
+    size_t bytes_per_pixel,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* result,
+    size_t result_offset,
+    const SwizzleOptions& options
+);
+
+/// The mipmaps `mip_start..mip_start + mip_count` of array layer `layer` in `layout`.
+std::span<const MipLayout> layer_mips(const SurfaceLayout& layout, size_t layer, size_t mip_start, size_t mip_count);
+
+/// Calculates the size in bytes for the tightly packed deswizzled data
+/// of mipmaps `mip_start..mip_start + mip_count` of array layer `layer`.
+/// Compare with [deswizzle_surface_mips].
+size_t deswizzled_mips_size(const SurfaceLayout& layout, size_t layer, size_t mip_start, size_t mip_count);
+
+/// Deswizzles only mipmaps `mip_start..mip_start + mip_count` of array layer `layer`
+/// from the swizzled surface `source` into the caller provided `result`.
+/// The mipmaps are tightly packed in `result` starting with `mip_start`.
+///
+/// The offsets in `source` are the same as for [deswizzle_surface], including the alignment between layers.
+/// `source` only needs to extend to the end of the last requested mipmap,
+/// so surfaces can be deswizzled as their data is loaded.
+///
+/// Throws if the layer or mipmap range is outside the surface, `source` does not contain the requested mipmaps,
+/// or `result` has fewer bytes than [deswizzled_mips_size].
+void deswizzle_surface_mips(
+    const SurfaceLayout& layout,
+    std::span<const std::byte> source,
+    size_t layer,
+    size_t mip_start,
+    size_t mip_count,
+    std::span<std::byte> result,
+    const SwizzleOptions& options = SwizzleOptions()
+);
@@ -0,0 +1,875 @@
+#include <tegra_swizzle/lib.h>
+
+GobKernels gob_kernels_for(SimdLevel level) {
+#if defined(TEGRA_SWIZZLE_X86)
+    switch (level) {
+    case SimdLevel::AVX512:
+        return GobKernels{
+            deswizzle_complete_gob_avx512<false>,
+            swizzle_complete_gob_avx512<false>,
+            deswizzle_complete_gob_avx512<true>,
+            swizzle_complete_gob_avx512<true>,
+            64
+        };
+    case SimdLevel::AVX2:
+        return GobKernels{
+            deswizzle_complete_gob_avx2<false>,
+            swizzle_complete_gob_avx2<false>,
+            deswizzle_complete_gob_avx2<true>,
+            swizzle_complete_gob_avx2<true>,
+            32
+        };
+    case SimdLevel::SSE2:
+        return GobKernels{
+            deswizzle_complete_gob_sse2<false>,
+            swizzle_complete_gob_sse2<false>,
+            deswizzle_complete_gob_sse2<true>,
+            swizzle_complete_gob_sse2<true>,
+            16
+        };
+    default:
+        break;
+    }
+#endif
+    // The scalar functions have no streaming version.
+    return GobKernels{ deswizzle_complete_gob, swizzle_complete_gob, deswizzle_complete_gob, swizzle_complete_gob, 1 };
+}
+
+const GobKernels& gob_kernels() {
+    static const GobKernels kernels = gob_kernels_for(detect_simd_level());
+    return kernels;
+}
+
+// Zero the swizzled GOBs that contain no pixel data without touching the rest of the destination.
+// This includes the GOB rows past the height in the last row of blocks,
+// the depth slices past the depth in the last layer of blocks,
+// and any bytes between the end of the blocks and `destination_size`.
+// The partially filled GOBs along the right and bottom edge are handled while swizzling.
+static void zero_swizzled_padding(
+    unsigned char* destination,
+    size_t destination_size,
+    size_t width,
+    size_t height,
+    size_t depth,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel
+) {
+    const size_t _block_height = static_cast<size_t>(block_height);
+    const size_t _width_in_gobs = width_in_gobs(width, bytes_per_pixel);
+    const size_t _height_in_blocks = height_in_blocks(height, _block_height);
+    const size_t _slice_size = slice_size(_block_height, block_depth, _width_in_gobs, height);
+
+    const size_t block_size_in_bytes = GOB_SIZE_IN_BYTES * _block_height * block_depth;
+    const size_t block_height_in_bytes = GOB_HEIGHT_IN_BYTES * _block_height;
+
+    // GOB rows below the last GOB containing data are contiguous within each block.
+    const size_t used_gob_rows = div_round_up(height, GOB_HEIGHT_IN_BYTES) - (_height_in_blocks - 1) * _block_height;
+    if (used_gob_rows < _block_height) {
+        const size_t offset_y = gob_address_y(
+            (_height_in_blocks - 1) * block_height_in_bytes,
+            block_height_in_bytes,
+            block_size_in_bytes,
+            _width_in_gobs
+        );
+        for (size_t z = 0; z < depth; ++z) {
+            const size_t offset_z = gob_address_z(z, _block_height, block_depth, _slice_size);
+            for (size_t x = 0; x < _width_in_gobs; ++x) {
+                unsigned char* start = destination
+                    + offset_z
+                    + offset_y
+                    + gob_address_x(x * GOB_WIDTH_IN_BYTES, block_size_in_bytes)
+                    + used_gob_rows * GOB_SIZE_IN_BYTES;
+                std::fill(start, start + (_block_height - used_gob_rows) * GOB_SIZE_IN_BYTES, (unsigned char)0);
+            }
+        }
+    }
+
+    // Depth slices past the depth are contiguous within each block.
+    const size_t depth_in_blocks = div_round_up(depth, block_depth);
+    const size_t used_slices = depth - (depth_in_blocks - 1) * block_depth;
+    if (used_slices < block_depth) {
+        const size_t offset_z = (depth_in_blocks - 1) * _slice_size;
+        const size_t slice_gob_size = GOB_SIZE_IN_BYTES * _block_height;
+        for (size_t block = 0; block < _width_in_gobs * _height_in_blocks; ++block) {
+            unsigned char* start = destination + offset_z + block * block_size_in_bytes + used_slices * slice_gob_size;
+            std::fill(start, start + (block_depth - used_slices) * slice_gob_size, (unsigned char)0);
+        }
+    }
+
+    const size_t blocks_size = depth_in_blocks * _slice_size;
+    if (blocks_size < destination_size) {
+        std::fill(destination + blocks_size, destination + destination_size, (unsigned char)0);
+    }
+}
+
+// Writes the first and last byte of each row of a complete deswizzled GOB for SwizzleOptions::first_touch.
+// The rows may cross a page boundary if the destination is not aligned.
+static void touch_deswizzled_gob(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    (void)src;
+    for (size_t i = 0; i < GOB_HEIGHT_IN_BYTES; ++i) {
+        dst[row_size_in_bytes * i] = 0;
+        dst[row_size_in_bytes * i + GOB_WIDTH_IN_BYTES - 1] = 0;
+    }
+}
+
+// Writes the first and last byte of a complete swizzled GOB for SwizzleOptions::first_touch.
+static void touch_swizzled_gob(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
+    (void)src;
+    (void)row_size_in_bytes;
+    dst[0] = 0;
+    dst[GOB_SIZE_IN_BYTES - 1] = 0;
+}
+
+// Rows of blocks up to this size stay in the L2 cache, so the traversal order does not matter.
+const size_t LINEAR_TRAVERSAL_MAX_BLOCK_ROW_SIZE = 256 * 1024;
+
+// Picks the traversal order for TraversalOrder::Auto.
+// Small surfaces and 2D surfaces use the linear order,
+// which keeps the deswizzled accesses sequential and only touches a few rows at a time.
+// The linear order jumps between depth slices of each block for large 3D surfaces,
+// so visit each block's GOBs together and keep the swizzled writes sequential when swizzling.
+template <bool DESWIZZLE>
+TraversalOrder resolve_traversal_order(TraversalOrder order, size_t block_row_size_in_bytes, size_t depth) {
+    if (order != TraversalOrder::Auto) {
+        return order;
+    }
+
+    if (depth == 1 || block_row_size_in_bytes <= LINEAR_TRAVERSAL_MAX_BLOCK_ROW_SIZE) {
+        return TraversalOrder::Linear;
+    }
+
+    // Visiting a single depth slice at a time limits how many deswizzled rows are written at once.
+    return DESWIZZLE ? TraversalOrder::BlockColumns : TraversalOrder::Swizzled;
+}
+
+// How many GOBs ahead of the current GOB to prefetch for streaming swizzles.
+// This should cover the memory latency without prefetching lines that get evicted before they are used.
+const size_t STREAMING_PREFETCH_DISTANCE_IN_GOBS = 4;
+
+// Runs tasks `task_start..task_end` of `work` with optional compile time values.
+// A BYTES_PER_PIXEL or BLOCK_HEIGHT of 0 uses the runtime value instead.
+// Compile time values reduce the divisions and multiplications in the address calculations to shifts and masks.
+template <bool DESWIZZLE, size_t BYTES_PER_PIXEL, size_t BLOCK_HEIGHT>
+void swizzle_tasks(const MipWork& work, size_t task_start, size_t task_end) {
+    const size_t width = work.width;
+    const size_t height = work.height;
+    const size_t depth = work.depth;
+    const unsigned char* source = work.source;
+    unsigned char* destination = work.destination;
+    const size_t block_depth = work.block_depth;
+    const bool large = work.large;
+    const size_t linear_origin = work.linear_origin;
+    const size_t swizzled_origin = work.swizzled_origin;
+
+    const size_t bytes_per_pixel = BYTES_PER_PIXEL != 0 ? BYTES_PER_PIXEL : work.bytes_per_pixel;
+    const size_t _block_height = BLOCK_HEIGHT != 0 ? BLOCK_HEIGHT : static_cast<size_t>(work.block_height);
+    const size_t _width_in_gobs = width_in_gobs(width, bytes_per_pixel);
+
+    const size_t _slice_size = slice_size(_block_height, block_depth, _width_in_gobs, height);
+
+    // Blocks are always one GOB wide.
+    // TODO: Citation?
+    const size_t block_width = 1;
+    const size_t block_size_in_bytes = GOB_SIZE_IN_BYTES * block_width * _block_height * block_depth;
+    const size_t block_height_in_bytes = GOB_HEIGHT_IN_BYTES * _block_height;
+
+    const CompleteGobFn complete_gob = work.complete_gob;
+
+    // Swizzling is defined as a mapping from byte coordinates x,y,z -> x',y',z'.
+    // We step a GOB of bytes at a time to optimize the inner loop with SIMD loads/stores.
+    // GOBs always use the same swizzle patterns, so we can optimize swizzling complete 64x8 GOBs.
+    // The partially filled GOBs along the right and bottom edge use a slower per byte implementation.
+    // The bytes per pixel converts pixel coordinates to byte coordinates.
+    // This assumes BCN formats pass in their width and height in number of blocks rather than pixels.
+    auto swizzle_gob = [&](size_t x0, size_t y0, size_t z0, size_t offset_z, size_t offset_y) {
+        const size_t offset_x = gob_address_x(x0, block_size_in_bytes);
+
+        const size_t gob_address = offset_z + offset_y + offset_x - swizzled_origin;
+
+        if (x0 + GOB_WIDTH_IN_BYTES <= width * bytes_per_pixel
+            && y0 + GOB_HEIGHT_IN_BYTES <= height)
+        {
+            const size_t linear_offset = (z0 * width * height * bytes_per_pixel)
+                + (y0 * width * bytes_per_pixel)
+                + x0
+                - linear_origin;
+
+            // Request the GOB a few columns ahead while this GOB is processed.
+            const size_t prefetch_x = x0 + GOB_WIDTH_IN_BYTES * STREAMING_PREFETCH_DISTANCE_IN_GOBS;
+            if (large && prefetch_x + GOB_WIDTH_IN_BYTES <= width * bytes_per_pixel) {
+                if (DESWIZZLE) {
+                    prefetch_gob(source + (offset_z + offset_y + gob_address_x(prefetch_x, block_size_in_bytes) - swizzled_origin), GOB_WIDTH_IN_BYTES);
+                }
+                else {
+                    prefetch_gob(source + linear_offset + prefetch_x - x0, width * bytes_per_pixel);
+                }
+            }
+
+            // Use optimized code to reassign bytes.
+            if (DESWIZZLE) {
+                complete_gob(
+                    destination + linear_offset,
+                    source + gob_address,
+                    width * bytes_per_pixel
+                );
+            }
+            else {
+                complete_gob(
+                    destination + gob_address,
+                    source + linear_offset,
+                    width * bytes_per_pixel
+                );
+            }
+        }
+        else {
+            // The bytes outside the surface are padding.
+            if (!DESWIZZLE) {
+                std::fill(
+                    destination + gob_address,
+                    destination + gob_address + GOB_SIZE_IN_BYTES,
+                    (unsigned char)0
+                );
+            }
+
+            // There may be a row and column with partially filled GOBs.
+            // Fall back to a slow implementation that iterates over each byte.
+            swizzle_deswizzle_gob<DESWIZZLE>(
+                destination,
+                source,
+                x0,
+                y0,
+                z0,
+                width,
+                height,
+                bytes_per_pixel,
+                gob_address,
+                linear_origin
+            );
+        }
+    };
+
+    const size_t _height_in_blocks = height_in_blocks(height, _block_height);
+    const TraversalOrder order = work.order;
+
+    // Each task covers a band of GOB rows from a row of blocks in one or more depth slices.
+    // Tasks read and write disjoint memory, so they can run in parallel.
+    const size_t row_bands = work.row_bands;
+    const size_t band_height_in_bytes = block_height_in_bytes / row_bands;
+    auto swizzle_task = [&](size_t z_start, size_t z_end, size_t block_y, size_t band) {
+        const size_t y_start = block_y * block_height_in_bytes + band * band_height_in_bytes;
+        const size_t y_end = std::min(y_start + band_height_in_bytes, height);
+
+        switch (order) {
+        case TraversalOrder::Swizzled:
+            // Follow the swizzled memory order of blocks, depth slices within a block, and then GOBs.
+            for (size_t x0 = 0; x0 < width * bytes_per_pixel; x0 += GOB_WIDTH_IN_BYTES) {
+                for (size_t z0 = z_start; z0 < z_end; ++z0) {
+                    const size_t offset_z = gob_address_z(z0, _block_height, block_depth, _slice_size);
+                    for (size_t y0 = y_start; y0 < y_end; y0 += GOB_HEIGHT_IN_BYTES) {
+                        const size_t offset_y = gob_address_y(y0, block_height_in_bytes, block_size_in_bytes, _width_in_gobs);
+                        swizzle_gob(x0, y0, z0, offset_z, offset_y);
+                    }
+                }
+            }
+            break;
+        case TraversalOrder::BlockColumns:
+            // Finish the column of GOBs in each block before moving to the next block.
+            for (size_t z0 = z_start; z0 < z_end; ++z0) {
+                const size_t offset_z = gob_address_z(z0, _block_height, block_depth, _slice_size);
+                for (size_t x0 = 0; x0 < width * bytes_per_pixel; x0 += GOB_WIDTH_IN_BYTES) {
+                    for (size_t y0 = y_start; y0 < y_end; y0 += GOB_HEIGHT_IN_BYTES) {
+                        const size_t offset_y = gob_address_y(y0, block_height_in_bytes, block_size_in_bytes, _width_in_gobs);
+                        swizzle_gob(x0, y0, z0, offset_z, offset_y);
+                    }
+                }
+            }
+            break;
+        default:
+            // Follow the deswizzled memory order of rows of GOBs and then columns of GOBs.
+            for (size_t z0 = z_start; z0 < z_end; ++z0) {
+                const size_t offset_z = gob_address_z(z0, _block_height, block_depth, _slice_size);
+                for (size_t y0 = y_start; y0 < y_end; y0 += GOB_HEIGHT_IN_BYTES) {
+                    const size_t offset_y = gob_address_y(y0, block_height_in_bytes, block_size_in_bytes, _width_in_gobs);
+                    for (size_t x0 = 0; x0 < width * bytes_per_pixel; x0 += GOB_WIDTH_IN_BYTES) {
+                        swizzle_gob(x0, y0, z0, offset_z, offset_y);
+                    }
+                }
+            }
+            break;
+        }
+    };
+
+
+    // The swizzled order visits all the depth slices of a block together.
+    const size_t slices_per_task = order == TraversalOrder::Swizzled ? block_depth : 1;
+    for (size_t task = task_start; task < task_end; ++task) {
+        const size_t row = task / row_bands;
+        const size_t z_start = (row / _height_in_blocks) * slices_per_task;
+        swizzle_task(z_start, std::min(z_start + slices_per_task, depth), row % _height_in_blocks, task % row_bands);
+    }
+
+    // Make the non-temporal stores visible before other threads read the results.
+    if (work.streaming) {
+        stream_fence();
+    }
+}
+
+template <bool DESWIZZLE, size_t BYTES_PER_PIXEL>
+MipTasksFn swizzle_tasks_block_height(BlockHeight block_height) {
+    switch (block_height) {
+    case BlockHeight::One:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 1>;
+    case BlockHeight::Two:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 2>;
+    case BlockHeight::Four:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 4>;
+    case BlockHeight::Eight:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 8>;
+    case BlockHeight::Sixteen:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 16>;
+    case BlockHeight::ThirtyTwo:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 32>;
+    default:
+        return swizzle_tasks<DESWIZZLE, BYTES_PER_PIXEL, 0>;
+    }
+}
+
+// Select a specialized implementation for the most common formats and block heights.
+// Other bytes per pixel values like 3 or 12 use the generic implementation.
+template <bool DESWIZZLE>
+MipTasksFn swizzle_tasks_for(size_t bytes_per_pixel, BlockHeight block_height) {
+    switch (bytes_per_pixel) {
+    case 1:
+        return swizzle_tasks_block_height<DESWIZZLE, 1>(block_height);
+    case 2:
+        return swizzle_tasks_block_height<DESWIZZLE, 2>(block_height);
+    case 4:
+        return swizzle_tasks_block_height<DESWIZZLE, 4>(block_height);
+    case 8:
+        return swizzle_tasks_block_height<DESWIZZLE, 8>(block_height);
+    case 16:
+        return swizzle_tasks_block_height<DESWIZZLE, 16>(block_height);
+    default:
+        return swizzle_tasks<DESWIZZLE, 0, 0>;
+    }
+}
+
+template <bool DESWIZZLE>
+MipWork mip_work(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+) {
+    (void)source_size;
+
+    const size_t _block_height = static_cast<size_t>(block_height);
+    const size_t _width_in_gobs = width_in_gobs(width, bytes_per_pixel);
+    const size_t block_size_in_bytes = GOB_SIZE_IN_BYTES * _block_height * block_depth;
+
+    MipWork work;
+    work.width = width;
+    work.height = height;
+    work.depth = depth;
+    work.source = source;
+    work.destination = destination;
+    work.block_height = block_height;
+    work.block_depth = block_depth;
+    work.bytes_per_pixel = bytes_per_pixel;
+    work.size_in_bytes = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
+
+    // Mipmaps much larger than the cache are only written once,
+    // so bypass the cache for the output and prefetch the input instead.
+    // Swizzled GOBs are 512 byte aligned, so only the deswizzled rows can be misaligned.
+    const GobKernels& kernels = gob_kernels(options);
+    const size_t alignment_mask = kernels.stream_alignment - 1;
+    const uintptr_t alignment_bits = DESWIZZLE
+        ? reinterpret_cast<uintptr_t>(destination) | (width * bytes_per_pixel)
+        : reinterpret_cast<uintptr_t>(destination);
+    work.large = work.size_in_bytes >= options.streaming_threshold_in_bytes;
+    work.streaming = work.large && (alignment_bits & alignment_mask) == 0;
+
+    work.complete_gob = work.streaming
+        ? (DESWIZZLE ? kernels.stream_deswizzle : kernels.stream_swizzle)
+        : (DESWIZZLE ? kernels.deswizzle : kernels.swizzle);
+    work.touch_gob = DESWIZZLE ? touch_deswizzled_gob : touch_swizzled_gob;
+
+    // Every deswizzled byte is written, but swizzled surfaces have padding.
+    if (!DESWIZZLE) {
+        zero_swizzled_padding(
+            destination,
+            destination_size,
+            width,
+            height,
+            depth,
+            block_height,
+            block_depth,
+            bytes_per_pixel
+        );
+    }
+
+    work.order = resolve_traversal_order<DESWIZZLE>(
+        options.traversal_order,
+        block_size_in_bytes * _width_in_gobs,
+        depth
+    );
+
+    // Each task covers a row of blocks in one or more depth slices.
+    // Tasks read and write disjoint memory, so they can run in parallel.
+    const size_t slices_per_task = work.order == TraversalOrder::Swizzled ? block_depth : 1;
+    work.task_count = div_round_up(depth, slices_per_task) * height_in_blocks(height, _block_height);
+    work.row_bands = 1;
+    work.linear_origin = 0;
+    work.swizzled_origin = 0;
+    work.run = swizzle_tasks_for<DESWIZZLE>(bytes_per_pixel, block_height);
+    return work;
+}
+
+template <bool DESWIZZLE>
+bool swizzle_inner(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+) {
+    const MipWork work = mip_work<DESWIZZLE>(
+        width,
+        height,
+        depth,
+        source,
+        source_size,
+        destination,
+        destination_size,
+        block_height,
+        block_depth,
+        bytes_per_pixel,
+        options
+    );
+    return run_mip_work(std::span<const MipWork>(&work, 1), options);
+}
+
+template MipWork mip_work<false>(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
+
+template MipWork mip_work<true>(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
+
+template bool swizzle_inner<false>(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
+
+template bool swizzle_inner<true>(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
+
+void swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    unsigned char** destination,
+    size_t* destination_size,
+    const SwizzleOptions& options
+) {
+    // Validate the source length before attempting to allocate.
+    const size_t expected_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
+    if (source_size < expected_size) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    *destination_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
+    *destination = new unsigned char[*destination_size];
+
+    // TODO: This should be a parameter since it varies by mipmap?
+    const size_t _block_depth = block_depth(depth);
+
+    const bool completed = swizzle_inner<false>(
+        width,
+        height,
+        depth,
+        source,
+        source_size,
+        *destination,
+        *destination_size,
+        block_height,
+        _block_depth,
+        bytes_per_pixel,
+        options
+    );
+    if (!completed) {
+        delete[] *destination;
+        *destination = nullptr;
+        *destination_size = 0;
+        throw_runtime_error(swizzle_error_message(SwizzleError::Cancelled));
+    }
+}
+
+SwizzleExpected<size_t> try_swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<size_t> {
+        const std::optional<SwizzleErrorInfo> source_error = check_size(
+            SwizzleError::NotEnoughData,
+            deswizzled_mip_size(width, height, depth, bytes_per_pixel),
+            source.size()
+        );
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        const size_t destination_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
+        const std::optional<SwizzleErrorInfo> destination_error = check_size(
+            SwizzleError::DestinationTooSmall,
+            destination_size,
+            destination.size()
+        );
+        if (destination_error) {
+            return SwizzleUnexpected(*destination_error);
+        }
+
+        unsigned char* _destination = reinterpret_cast<unsigned char*>(destination.data());
+
+        const bool completed = swizzle_inner<false>(
+            width,
+            height,
+            depth,
+            reinterpret_cast<const unsigned char*>(source.data()),
+            source.size(),
+            _destination,
+            destination_size,
+            block_height,
+            block_depth(depth),
+            bytes_per_pixel,
+            options
+        );
+        if (!completed) {
+            return SwizzleUnexpected(SwizzleErrorInfo{ SwizzleError::Cancelled, 0, 0 });
+        }
+
+        return destination_size;
+    });
+}
+
+void swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+) {
+    const SwizzleExpected<size_t> result = try_swizzle_block_linear(
+        width,
+        height,
+        depth,
+        source,
+        block_height,
+        bytes_per_pixel,
+        destination,
+        options
+    );
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+}
+
+SwizzleExpected<SwizzleBuffer> try_swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<SwizzleBuffer> {
+        const std::optional<SwizzleErrorInfo> source_error = check_size(
+            SwizzleError::NotEnoughData,
+            deswizzled_mip_size(width, height, depth, bytes_per_pixel),
+            source.size()
+        );
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        SwizzleBuffer destination = output_buffer(swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel), resource, options);
+        const SwizzleExpected<size_t> result = try_swizzle_block_linear(width, height, depth, source, block_height, bytes_per_pixel, destination.span(), options);
+        if (!result) {
+            return SwizzleUnexpected(result.error());
+        }
+        return destination;
+    });
+}
+
+SwizzleBuffer swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    SwizzleExpected<SwizzleBuffer> result = try_swizzle_block_linear(
+        width,
+        height,
+        depth,
+        source,
+        block_height,
+        bytes_per_pixel,
+        resource,
+        options
+    );
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+    return std::move(*result);
+}
+
+void deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    unsigned char** destination,
+    size_t* destination_size,
+    const SwizzleOptions& options
+) {
+    // Validate the source length before attempting to allocate.
+    const size_t expected_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
+    if (source_size < expected_size) {
+        throw_runtime_error("Not enough data!");
+    }
+
+    *destination_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
+    *destination = new unsigned char[*destination_size];
+
+    const size_t _block_depth = block_depth(depth);
+
+    const bool completed = swizzle_inner<true>(
+        width,
+        height,
+        depth,
+        source,
+        source_size,
+        *destination,
+        *destination_size,
+        block_height,
+        _block_depth,
+        bytes_per_pixel,
+        options
+    );
+    if (!completed) {
+        delete[] *destination;
+        *destination = nullptr;
+        *destination_size = 0;
+        throw_runtime_error(swizzle_error_message(SwizzleError::Cancelled));
+    }
+}
+
+SwizzleExpected<size_t> try_deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<size_t> {
+        const std::optional<SwizzleErrorInfo> source_error = check_size(
+            SwizzleError::NotEnoughData,
+            swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel),
+            source.size()
+        );
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        const size_t destination_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
+        const std::optional<SwizzleErrorInfo> destination_error = check_size(
+            SwizzleError::DestinationTooSmall,
+            destination_size,
+            destination.size()
+        );
+        if (destination_error) {
+            return SwizzleUnexpected(*destination_error);
+        }
+
+        unsigned char* _destination = reinterpret_cast<unsigned char*>(destination.data());
+
+        const bool completed = swizzle_inner<true>(
+            width,
+            height,
+            depth,
+            reinterpret_cast<const unsigned char*>(source.data()),
+            source.size(),
+            _destination,
+            destination_size,
+            block_height,
+            block_depth(depth),
+            bytes_per_pixel,
+            options
+        );
+        if (!completed) {
+            return SwizzleUnexpected(SwizzleErrorInfo{ SwizzleError::Cancelled, 0, 0 });
+        }
+
+        return destination_size;
+    });
+}
+
+void deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options
+) {
+    const SwizzleExpected<size_t> result = try_deswizzle_block_linear(
+        width,
+        height,
+        depth,
+        source,
+        block_height,
+        bytes_per_pixel,
+        destination,
+        options
+    );
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+}
+
+SwizzleExpected<SwizzleBuffer> try_deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) noexcept {
+    return catch_resource_errors([&]() -> SwizzleExpected<SwizzleBuffer> {
+        const std::optional<SwizzleErrorInfo> source_error = check_size(
+            SwizzleError::NotEnoughData,
+            swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel),
+            source.size()
+        );
+        if (source_error) {
+            return SwizzleUnexpected(*source_error);
+        }
+
+        SwizzleBuffer destination = output_buffer(deswizzled_mip_size(width, height, depth, bytes_per_pixel), resource, options);
+        const SwizzleExpected<size_t> result = try_deswizzle_block_linear(width, height, depth, source, block_height, bytes_per_pixel, destination.span(), options);
+        if (!result) {
+            return SwizzleUnexpected(result.error());
+        }
+        return destination;
+    });
+}
+
+SwizzleBuffer deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource,
+    const SwizzleOptions& options
+) {
+    SwizzleExpected<SwizzleBuffer> result = try_deswizzle_block_linear(
+        width,
+        height,
+        depth,
+        source,
+        block_height,
+        bytes_per_pixel,
+        resource,
+        options
+    );
+    if (!result) {
+        throw_runtime_error(swizzle_error_message(result.error().error));
+    }
+    return std::move(*result);
+}
@@ -1,12 +1,18 @@
 #pragma once
 
 #include <tegra_swizzle/blockdepth.h>
-#include <stdexcept>
+#include <tegra_swizzle/buffer.h>
+#include <tegra_swizzle/expected.h>
+#include <tegra_swizzle/kernels.h>
+#include <tegra_swizzle/parallel.h>
+#include <span>
+#include <cstddef>
+#include <cstdint>
 
 // The gob address and slice size functions are ported from Ryujinx Emulator.
 // https://github.com/Ryujinx/Ryujinx/blob/master/Ryujinx.Graphics.Texture/BlockLinearLayout.cs
 // License MIT: https://github.com/Ryujinx/Ryujinx/blob/master/LICENSE.txt.
-size_t slice_size(
+inline size_t slice_size(
     size_t block_height,
     size_t block_depth,
     size_t width_in_gobs,
@@ -16,7 +22,7 @@ size_t slice_size(
     return div_round_up(height, block_height * GOB_HEIGHT_IN_BYTES) * rob_size;
 }
 
-size_t gob_address_z(
+inline size_t gob_address_z(
     size_t z,
     size_t block_height,
     size_t block_depth,
@@ -25,7 +31,7 @@ size_t gob_address_z(
     return (z / block_depth * slice_size) + ((z & (block_depth - 1)) * GOB_SIZE_IN_BYTES * block_height);
 }
 
-size_t gob_address_y(
+inline size_t gob_address_y(
     size_t y,
     size_t block_height_in_bytes,
     size_t block_size_in_bytes,
@@ -37,26 +43,24 @@ size_t gob_address_y(
 }
 
 // Code for offset_x and offset_y adapted from examples in the Tegra TRM page 1187.
-size_t gob_address_x(size_t x, size_t block_size_in_bytes) {
+inline size_t gob_address_x(size_t x, size_t block_size_in_bytes) {
     const size_t block_x = x / GOB_WIDTH_IN_BYTES;
     return block_x * block_size_in_bytes;
 }
 
 // Code taken from examples in Tegra TRM page 1188.
 // Return the offset within the GOB for the byte at location (x, y).
-size_t gob_offset(size_t x, size_t y) {
+inline size_t gob_offset(size_t x, size_t y) {
     // TODO: Optimize this?
     // TODO: Describe the pattern here?
     return ((x % 64) / 32) * 256 + ((y % 8) / 2) * 64 + ((x % 32) / 16) * 32 + (y % 2) * 16 + (x % 16);
 }
 
 // TODO: Investigate using macros to generate this code.
-// TODO: Is it faster to use 16 byte loads for each row on incomplete GOBs?
-// This may lead to better performance if the GOB is almost complete.
 
 constexpr size_t GOB_ROW_OFFSETS[GOB_HEIGHT_IN_BYTES] = { 0, 16, 64, 80, 128, 144, 192, 208 };
 
-void deswizzle_gob_row(unsigned char* dst, size_t dst_offset, unsigned char* src, size_t src_offset) {
+inline void deswizzle_gob_row(unsigned char* dst, size_t dst_offset, const unsigned char* src, size_t src_offset) {
     // Start with the largest offset first to reduce bounds checks.
     std::copy(src + src_offset + 288, src + src_offset + 304, dst + dst_offset + 48);
     std::copy(src + src_offset + 256, src + src_offset + 272, dst + dst_offset + 32);
@@ -64,7 +68,7 @@ void deswizzle_gob_row(unsigned char* dst, size_t dst_offset, unsigned char* src
     std::copy(src + src_offset, src + src_offset + 16, dst + dst_offset);
 }
 
-void swizzle_gob_row(unsigned char* dst, size_t dst_offset, unsigned char* src, size_t src_offset) {
+inline void swizzle_gob_row(unsigned char* dst, size_t dst_offset, const unsigned char* src, size_t src_offset) {
     std::copy(src + src_offset + 48, src + src_offset + 64, dst + dst_offset + 288);
     std::copy(src + src_offset + 32, src + src_offset + 48, dst + dst_offset + 256);
     std::copy(src + src_offset + 16, src + src_offset + 32, dst + dst_offset + 32);
@@ -74,7 +78,7 @@ void swizzle_gob_row(unsigned char* dst, size_t dst_offset, unsigned char* src,
 // An optimized version of the gob_offset for an entire GOB worth of bytes.
 // The swizzled GOB is a contiguous region of 512 bytes.
 // The deswizzled GOB is a 64x8 2D region of memory, so we need to account for the pitch.
-void deswizzle_complete_gob(unsigned char* dst, unsigned char* src, size_t row_size_in_bytes) {
+inline void deswizzle_complete_gob(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
     // Hard code each of the GOB_HEIGHT many rows.
     // This allows the compiler to optimize the copies with SIMD instructions.
     for (size_t i = 0; i < sizeof(GOB_ROW_OFFSETS) / sizeof(GOB_ROW_OFFSETS[0]); i++) {
@@ -83,12 +87,20 @@ void deswizzle_complete_gob(unsigned char* dst, unsigned char* src, size_t row_s
 }
 
 // The swizzle functions are identical but with the addresses swapped.
-void swizzle_complete_gob(unsigned char* dst, unsigned char* src, size_t row_size_in_bytes) {
+inline void swizzle_complete_gob(unsigned char* dst, const unsigned char* src, size_t row_size_in_bytes) {
     for (size_t i = 0; i < sizeof(GOB_ROW_OFFSETS) / sizeof(GOB_ROW_OFFSETS[0]); ++i) {
         swizzle_gob_row(dst, GOB_ROW_OFFSETS[i], src, row_size_in_bytes * i);
     }
 }
 
+/// Returns the complete GOB functions for `level`.
+/// The scalar functions are used for unsupported levels and non x86 targets.
+GobKernels gob_kernels_for(SimdLevel level);
+
+/// The complete GOB functions for the current CPU.
+/// The CPU features are only checked once on the first call.
+const GobKernels& gob_kernels();
+
 /// Calculates the size in bytes for the swizzled data for the given dimensions for the block linear format.
 /// The result of [swizzled_mip_size] will always be at least as large as [deswizzled_mip_size]
 /// for the same surface parameters.
@@ -118,7 +130,7 @@ assert_eq!(262144, swizzled_mip_size(width, height, 1, BlockHeight::Sixteen, 4))
  );
  ```
   */
-size_t swizzled_mip_size(
+inline size_t swizzled_mip_size(
     size_t width,
     size_t height,
     size_t depth,
@@ -165,7 +177,7 @@ assert_eq!(262144, deswizzled_mip_size(width, height, 1, 4));
  );
  ```
   */
-size_t deswizzled_mip_size(
+inline size_t deswizzled_mip_size(
     size_t width,
     size_t height,
     size_t depth,
@@ -174,130 +186,170 @@ size_t deswizzled_mip_size(
     return width * height * depth * bytes_per_pixel;
 }
 
+// Swizzle or deswizzle the bytes in x_start..x_end and y_start..y_end of a single GOB.
+// The coordinates are relative to the GOB, and `linear_offset` is the deswizzled offset of (x_start, y_start).
+// Each 16 byte sector of a GOB row is contiguous in both the swizzled and deswizzled data,
+// so copy the part of each sector inside the range in a single run.
+template <bool DESWIZZLE>
+void swizzle_deswizzle_gob_rect(
+    unsigned char* destination,
+    const unsigned char* source,
+    size_t gob_address,
+    size_t linear_offset,
+    size_t row_pitch,
+    size_t x_start,
+    size_t x_end,
+    size_t y_start,
+    size_t y_end
+) {
+    for (size_t y = y_start; y < y_end; ++y) {
+        const size_t linear_row_offset = linear_offset + (y - y_start) * row_pitch;
+
+        size_t x = x_start;
+        while (x < x_end) {
+            const size_t run_end = std::min((x / 16 + 1) * 16, x_end);
+            const size_t swizzled_offset = gob_address + gob_offset(x, y);
+            const size_t linear_run_offset = linear_row_offset + (x - x_start);
+
+            // Swap the addresses for swizzling vs deswizzling.
+            if (DESWIZZLE) {
+                std::copy(source + swizzled_offset, source + swizzled_offset + (run_end - x), destination + linear_run_offset);
+            }
+            else {
+                std::copy(source + linear_run_offset, source + linear_run_offset + (run_end - x), destination + swizzled_offset);
+            }
+
+            x = run_end;
+        }
+    }
+}
+
+// Swizzle or deswizzle a partially filled GOB along the right or bottom edge.
+// The linear data starts at the deswizzled offset `linear_origin` of the mipmap.
 template <bool DESWIZZLE>
 void swizzle_deswizzle_gob(
     unsigned char* destination,
-    unsigned char* source,
+    const unsigned char* source,
     size_t x0,
     size_t y0,
     size_t z0,
     size_t width,
     size_t height,
     size_t bytes_per_pixel,
-    size_t gob_address
+    size_t gob_address,
+    size_t linear_origin
 ) {
-    for (size_t y = 0; y < GOB_HEIGHT_IN_BYTES; ++y) {
-        for (size_t x = 0; x < GOB_WIDTH_IN_BYTES; ++x) {
-            if (y0 + y < height && x0 + x < width * bytes_per_pixel) {
-                size_t swizzled_offset = gob_address + gob_offset(x, y);
-                size_t linear_offset = (z0 * width * height * bytes_per_pixel)
-                    + ((y0 + y) * width * bytes_per_pixel)
-                    + x0
-                    + x;
-
-                // Swap the addresses for swizzling vs deswizzling.
-                if (DESWIZZLE) {
-                    destination[linear_offset] = source[swizzled_offset];
-                }
-                else {
-                    destination[swizzled_offset] = source[linear_offset];
-                }
-            }
-        }
-    }
+    const size_t row_size_in_bytes = width * bytes_per_pixel;
+    const size_t linear_offset = (z0 * height * row_size_in_bytes)
+        + (y0 * row_size_in_bytes)
+        + x0
+        - linear_origin;
+
+    swizzle_deswizzle_gob_rect<DESWIZZLE>(
+        destination,
+        source,
+        gob_address,
+        linear_offset,
+        row_size_in_bytes,
+        0,
+        std::min(row_size_in_bytes - x0, GOB_WIDTH_IN_BYTES),
+        0,
+        std::min(height - y0, GOB_HEIGHT_IN_BYTES)
+    );
+}
+
+struct MipWork;
+
+/// Runs tasks `task_start..task_end` of a [MipWork].
+using MipTasksFn = void (*)(const MipWork& work, size_t task_start, size_t task_end);
+
+/// The work for swizzling or deswizzling a single mipmap split into independent tasks.
+/// Each task covers a row of blocks or a band of its GOB rows in one or more depth slices,
+/// so tasks read and write disjoint memory and can run in any order on any thread.
+struct MipWork {
+    size_t width;
+    size_t height;
+    size_t depth;
+    const unsigned char* source;
+    unsigned char* destination;
+    BlockHeight block_height;
+    size_t block_depth;
+    size_t bytes_per_pixel;
+    TraversalOrder order;
+    CompleteGobFn complete_gob;
+    /// Writes a byte to each page that [complete_gob] writes for [SwizzleOptions::first_touch].
+    CompleteGobFn touch_gob;
+    /// Prefetch the source for mipmaps at least [SwizzleOptions::streaming_threshold_in_bytes] in size.
+    bool large;
+    /// [complete_gob] uses non-temporal stores.
+    bool streaming;
+    /// The size in bytes of the deswizzled mipmap.
+    size_t size_in_bytes;
+    size_t task_count;
+    /// The number of tasks each row of blocks is split into.
+    /// Each band has the same number of GOB rows.
+    size_t row_bands;
+    /// The deswizzled offset in the mipmap of the first byte of the linear data.
+    /// Tasks only access linear data at or after this offset, so the linear data can hold only part of the mipmap.
+    size_t linear_origin;
+    /// The swizzled offset in the mipmap of the first byte of the swizzled data like [linear_origin].
+    size_t swizzled_origin;
+    MipTasksFn run;
+};
+
+// Splits the tasks of `work` into one task for each row of GOBs.
+// Smaller tasks let callers check a time budget more often for very wide mipmaps.
+inline void split_tasks_into_gob_rows(MipWork& work) {
+    const size_t row_bands = static_cast<size_t>(work.block_height);
+    work.task_count = work.task_count / work.row_bands * row_bands;
+    work.row_bands = row_bands;
 }
 
+// Faults in the destination pages of tasks `task_start..task_end` of `work` on the calling thread.
+// The partially filled GOBs along the right and bottom edge are written with their final values.
+inline void touch_tasks(const MipWork& work, size_t task_start, size_t task_end) {
+    MipWork touch = work;
+    touch.complete_gob = work.touch_gob;
+    touch.large = false;
+    touch.streaming = false;
+    touch.run(touch, task_start, task_end);
+}
+
+// Prepares the work for a single mipmap without running any tasks.
+// Swizzling also zeroes the padding in `destination` that is not written by any task.
+// Both directions are explicitly instantiated in swizzle.cpp.
 template <bool DESWIZZLE>
-void swizzle_inner(
+MipWork mip_work(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
+    const unsigned char* source,
     size_t source_size,
     unsigned char* destination,
     size_t destination_size,
     BlockHeight block_height,
     size_t block_depth,
-    size_t bytes_per_pixel
-) {
-    const size_t _block_height = static_cast<size_t>(block_height);
-    const size_t _width_in_gobs = width_in_gobs(width, bytes_per_pixel);
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
 
-    const size_t _slice_size = slice_size(_block_height, block_depth, _width_in_gobs, height);
-
-    // Blocks are always one GOB wide.
-    // TODO: Citation?
-    const size_t block_width = 1;
-    const size_t block_size_in_bytes = GOB_SIZE_IN_BYTES * block_width * _block_height * block_depth;
-    const size_t block_height_in_bytes = GOB_HEIGHT_IN_BYTES * _block_height;
-
-    // Swizzling is defined as a mapping from byte coordinates x,y,z -> x',y',z'.
-    // We step a GOB of bytes at a time to optimize the inner loop with SIMD loads/stores.
-    // GOBs always use the same swizzle patterns, so we can optimize swizzling complete 64x8 GOBs.
-    // The partially filled GOBs along the right and bottom edge use a slower per byte implementation.
-    for (size_t z0 = 0; z0 < depth; ++z0) {
-        const size_t offset_z = gob_address_z(z0, _block_height, block_depth, _slice_size);
-
-        // Step by a GOB of bytes in y.
-        for (size_t y0 = 0; y0 < height; y0 += GOB_HEIGHT_IN_BYTES) {
-            const size_t offset_y = gob_address_y(
-                y0,
-                block_height_in_bytes,
-                block_size_in_bytes,
-                _width_in_gobs
-            );
-
-            // Step by a GOB of bytes in x.
-            // The bytes per pixel converts pixel coordinates to byte coordinates.
-            // This assumes BCN formats pass in their width and height in number of blocks rather than pixels.
-            for (size_t x0 = 0; x0 < width * bytes_per_pixel; x0 += GOB_WIDTH_IN_BYTES) {
-                const size_t offset_x = gob_address_x(x0, block_size_in_bytes);
-
-                const size_t gob_address = offset_z + offset_y + offset_x;
-
-                if (x0 + GOB_WIDTH_IN_BYTES < width * bytes_per_pixel
-                    && y0 + GOB_HEIGHT_IN_BYTES < height)
-                {
-                    const size_t linear_offset = (z0 * width * height * bytes_per_pixel)
-                        + (y0 * width * bytes_per_pixel)
-                        + x0;
-
-                    // Use optimized code to reassign bytes.
-                    if (DESWIZZLE) {
-                        deswizzle_complete_gob(
-                            destination + linear_offset,
-                            source + gob_address,
-                            width * bytes_per_pixel
-                        );
-                    }
-                    else {
-                        swizzle_complete_gob(
-                            destination + gob_address,
-                            source + linear_offset,
-                            width * bytes_per_pixel
-                        );
-                    }
-                }
-                else {
-
-                    // There may be a row and column with partially filled GOBs.
-                    // Fall back to a slow implementation that iterates over each byte.
-                    swizzle_deswizzle_gob<DESWIZZLE>(
-                        destination,
-                        source,
-                        x0,
-                        y0,
-                        z0,
-                        width,
-                        height,
-                        bytes_per_pixel,
-                        gob_address
-                    );
-                }
-            }
-        }
-    }
-}
+// Swizzles or deswizzles a single mipmap using the threads from `options`.
+// Returns `false` if the stop token or deadline from `options` stopped the work early.
+// Both directions are explicitly instantiated in swizzle.cpp.
+template <bool DESWIZZLE>
+bool swizzle_inner(
+    size_t width,
+    size_t height,
+    size_t depth,
+    const unsigned char* source,
+    size_t source_size,
+    unsigned char* destination,
+    size_t destination_size,
+    BlockHeight block_height,
+    size_t block_depth,
+    size_t bytes_per_pixel,
+    const SwizzleOptions& options
+);
 
 /// Swizzles the bytes from `source` using the block linear swizzling algorithm.
 ///
@@ -342,38 +394,80 @@ void swizzle_block_linear(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
+    const unsigned char* source,
     size_t source_size,
     BlockHeight block_height,
     size_t bytes_per_pixel,
     unsigned char** destination,
-    size_t* destination_size
-) {
-    *destination_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
-    *destination = new unsigned char[*destination_size];
-    std::fill(*destination, *destination + *destination_size, (unsigned char)0);
+    size_t* destination_size,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    const size_t expected_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
-    if (source_size < expected_size) {
-        throw new std::runtime_error("Not enough data!");
-    }
+/// Swizzles the bytes from `source` into the caller provided `destination` without allocating or throwing.
+/// Only the first [swizzled_mip_size] bytes of `destination` are written.
+///
+/// Returns the number of bytes written.
+/// Fails with [SwizzleError::NotEnoughData] if `source` has fewer bytes than [deswizzled_mip_size]
+/// or [SwizzleError::DestinationTooSmall] if `destination` has fewer bytes than [swizzled_mip_size].
+/// Fails with [SwizzleError::Cancelled] if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work.
+/// Fails with [SwizzleError::OutOfResources] if memory for scheduling the work or threads cannot be allocated.
+SwizzleExpected<size_t> try_swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Swizzles the bytes from `source` into the caller provided `destination` without allocating.
+/// Only the first [swizzled_mip_size] bytes of `destination` are written.
+///
+/// Throws if `source` has fewer bytes than [deswizzled_mip_size]
+/// or `destination` has fewer bytes than [swizzled_mip_size].
+void swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    // TODO: This should be a parameter since it varies by mipmap?
-    const size_t _block_depth = block_depth(depth);
+/// Swizzles the bytes from `source` into a new [SwizzleBuffer] allocated from `resource` without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if `source` has fewer bytes than [deswizzled_mip_size].
+/// The source is checked before allocating.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SwizzleBuffer> try_swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
 
-    swizzle_inner<false>(
-        width,
-        height,
-        depth,
-        source,
-        source_size,
-        *destination,
-        *destination_size,
-        block_height,
-        _block_depth,
-        bytes_per_pixel
-    );
-}
+/// Swizzles the bytes from `source` into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than [deswizzled_mip_size].
+/// The source is checked before allocating.
+SwizzleBuffer swizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
 /// Deswizzles the bytes from `source` using the block linear swizzling algorithm.
 ///
@@ -418,34 +512,77 @@ void deswizzle_block_linear(
     size_t width,
     size_t height,
     size_t depth,
-    unsigned char* source,
+    const unsigned char* source,
     size_t source_size,
     BlockHeight block_height,
     size_t bytes_per_pixel,
     unsigned char** destination,
-    size_t* destination_size
-) {
-    *destination_size = deswizzled_mip_size(width, height, depth, bytes_per_pixel);
-    *destination = new unsigned char[*destination_size];
-    std::fill(*destination, *destination + *destination_size, (unsigned char)0);
+    size_t* destination_size,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    const size_t expected_size = swizzled_mip_size(width, height, depth, block_height, bytes_per_pixel);
-    if (source_size < expected_size) {
-        throw new std::runtime_error("Not enough data!");
-    }
+/// Deswizzles the bytes from `source` into the caller provided `destination` without allocating or throwing.
+/// Only the first [deswizzled_mip_size] bytes of `destination` are written.
+///
+/// Returns the number of bytes written.
+/// Fails with [SwizzleError::NotEnoughData] if `source` has fewer bytes than [swizzled_mip_size]
+/// or [SwizzleError::DestinationTooSmall] if `destination` has fewer bytes than [deswizzled_mip_size].
+/// Fails with [SwizzleError::Cancelled] if [SwizzleOptions::stop_token] or [SwizzleOptions::deadline] stops the work.
+/// Fails with [SwizzleError::OutOfResources] if memory for scheduling the work or threads cannot be allocated.
+SwizzleExpected<size_t> try_deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
 
-    const size_t _block_depth = block_depth(depth);
+/// Deswizzles the bytes from `source` into the caller provided `destination` without allocating.
+/// Only the first [deswizzled_mip_size] bytes of `destination` are written.
+///
+/// Throws if `source` has fewer bytes than [swizzled_mip_size]
+/// or `destination` has fewer bytes than [deswizzled_mip_size].
+void deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::span<std::byte> destination,
+    const SwizzleOptions& options = SwizzleOptions()
+);
 
-    swizzle_inner<true>(
-        width,
-        height,
-        depth,
-        source,
-        source_size,
-        *destination,
-        *destination_size,
-        block_height,
-        _block_depth,
-        bytes_per_pixel
-    );
-}
\ No newline at end of file
+/// Deswizzles the bytes from `source` into a new [SwizzleBuffer] allocated from `resource` without throwing.
+///
+/// Returns [SwizzleError::NotEnoughData] if `source` has fewer bytes than [swizzled_mip_size].
+/// The source is checked before allocating.
+/// Fails with [SwizzleError::OutOfResources] if the buffer or threads cannot be allocated.
+SwizzleExpected<SwizzleBuffer> try_deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+) noexcept;
+
+/// Deswizzles the bytes from `source` into a new [SwizzleBuffer] allocated from `resource`.
+///
+/// Throws if `source` has fewer bytes than [swizzled_mip_size].
+/// The source is checked before allocating.
+SwizzleBuffer deswizzle_block_linear(
+    size_t width,
+    size_t height,
+    size_t depth,
+    std::span<const std::byte> source,
+    BlockHeight block_height,
+    size_t bytes_per_pixel,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+    const SwizzleOptions& options = SwizzleOptions()
+);